@@ -0,0 +1,114 @@
+/*
+* The embeddable API of keybuilder.h, over the same profile as the keybuilder
+* program. A profile owns its ranges, a histogram of every length up to
+* max_key_size + 1, and a copy of the previous key for the velocities, so
+* adding a key only updates them under the profile's mutex.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "keybuilder.h"
+#include "profile.h"
+
+struct kb_profile {
+	pthread_mutex_t lock;
+	Profile profile;
+	char* previous;
+	size_t previous_length;
+};
+
+kb_profile* kb_profile_new(size_t max_key_size) {
+	kb_profile* profile = calloc(1, sizeof(*profile));
+	if (profile == NULL) {
+		return NULL;
+	}
+	profile->profile.width = max_key_size;
+	profile->profile.max_length = max_key_size + 1;
+	profile->profile.ranges = calloc(max_key_size + 1, sizeof(*profile->profile.ranges));
+	profile->profile.length_count = calloc(max_key_size + 2, sizeof(*profile->profile.length_count));
+	profile->previous = malloc(max_key_size + 1);
+	if (profile->profile.ranges == NULL || profile->profile.length_count == NULL || profile->previous == NULL
+		|| pthread_mutex_init(&profile->lock, NULL) != 0) {
+		free(profile->profile.ranges);
+		free(profile->profile.length_count);
+		free(profile->previous);
+		free(profile);
+		return NULL;
+	}
+	reset_ranges(profile->profile.ranges, max_key_size);
+	return profile;
+}
+
+void kb_profile_free(kb_profile* profile) {
+	if (profile == NULL) {
+		return;
+	}
+	pthread_mutex_destroy(&profile->lock);
+	free(profile->profile.ranges);
+	free(profile->profile.length_count);
+	free(profile->previous);
+	free(profile);
+}
+
+// the length histogram was allocated up to max_key_size + 1, so it never grows
+static void add_key(kb_profile* profile, const char* key, const size_t length) {
+	const size_t width = profile->profile.width;
+	const size_t counted_length = length <= width ? length : width + 1;
+	count_length(&profile->profile.length_count, &profile->profile.max_length, counted_length, 1);
+	add_line(&profile->profile, key, length, profile->previous, profile->previous_length);
+
+	profile->previous_length = length < width ? length : width;
+	memcpy(profile->previous, key, profile->previous_length);
+}
+
+void kb_profile_add(kb_profile* profile, const char* key, size_t length) {
+	pthread_mutex_lock(&profile->lock);
+	add_key(profile, key, length);
+	pthread_mutex_unlock(&profile->lock);
+}
+
+void kb_profile_add_batch(kb_profile* profile, const char* const* keys, const size_t* lengths, size_t count) {
+	pthread_mutex_lock(&profile->lock);
+	for (size_t i = 0; i < count; ++i) {
+		add_key(profile, keys[i], lengths[i]);
+	}
+	pthread_mutex_unlock(&profile->lock);
+}
+
+char* kb_profile_regex(kb_profile* profile) {
+	char* regex = NULL;
+	size_t size = 0;
+	pthread_mutex_lock(&profile->lock);
+	if (profile->profile.line_count > 0) {
+		FILE* out = open_memstream(&regex, &size);
+		if (out != NULL) {
+			print_profile(out, &profile->profile);
+			fclose(out);
+		}
+	}
+	pthread_mutex_unlock(&profile->lock);
+	return regex;
+}
+
+int kb_profile_serialize(kb_profile* profile, FILE* file) {
+	pthread_mutex_lock(&profile->lock);
+	int status = profile->profile.line_count == 0;
+	if (status == 0) {
+		// only the positions of the longest key have histograms
+		Profile written = profile->profile;
+		size_t longest = written.max_length;
+		while (longest > 0 && written.length_count[longest] == 0) {
+			--longest;
+		}
+		written.width = longest < written.width ? longest : written.width;
+		status = serialize_profile(&written, file);
+	}
+	pthread_mutex_unlock(&profile->lock);
+	return status;
+}
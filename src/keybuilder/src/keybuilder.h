@@ -0,0 +1,64 @@
+/*
+* Embeddable keybuilder: profiles keys inside another program, such as a
+* service that samples its live keys in the background, instead of piping them
+* to the keybuilder program. Build it with `make libkeybuilder.a` and link with
+* -lm -pthread.
+*
+*       kb_profile* profile = kb_profile_new(64);
+*       kb_profile_add(profile, key, key_length);       // from any thread
+*       char* regex = kb_profile_regex(profile);        // as printed by keybuilder
+*       free(regex);
+*       kb_profile_free(profile);
+*
+* Every function may be called from several threads on the same profile. All
+* the memory of a profile is allocated by kb_profile_new, so adding keys never
+* allocates, and only takes the profile's lock.
+*/
+
+#ifndef KEYBUILDER_H
+#define KEYBUILDER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kb_profile kb_profile;
+
+/*
+* Creates an empty profile. Only the first max_key_size bytes of every key are
+* profiled, and longer keys are counted as max_key_size + 1 bytes long, so they
+* show up as keys of different sizes. Returns NULL if memory is exhausted.
+*/
+kb_profile* kb_profile_new(size_t max_key_size);
+
+void kb_profile_free(kb_profile* profile);
+
+/* Adds a key, which does not need to be null terminated. */
+void kb_profile_add(kb_profile* profile, const char* key, size_t length);
+
+/* Adds count keys, taking the profile's lock only once. */
+void kb_profile_add_batch(kb_profile* profile, const char* const* keys, const size_t* lengths, size_t count);
+
+/*
+* Returns the regex of the keys added so far, and the options for keysynth in
+* a second line, exactly as the keybuilder program prints them. The string is
+* allocated with malloc, and must be freed by the caller. Returns NULL if no
+* key was added.
+*/
+char* kb_profile_regex(kb_profile* profile);
+
+/*
+* Writes the profile of the keys added so far to a file opened for binary
+* writing, in the format of `keybuilder --profile`, so the profiles of many
+* processes can be merged with `keybuilder --merge`. Returns 0 on success.
+*/
+int kb_profile_serialize(kb_profile* profile, FILE* file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,114 +16,366 @@
 * Upon reading the third line, we will update again to:
 *
 *                      [0-Z][0-Z]:[0-z][0-z]:[0-Z][0-Z]
+*
+* In a second line, we also print the OR and the AND of every position across
+* all lines, so keysynth knows exactly which bits vary, and the entropy of
+* every position.
+*
+* When the standard input is a regular file, it is memory mapped instead, and
+* split on line boundaries across threads. Every thread profiles its lines into
+* its own partial profile, 32 positions at a time with AVX2, and the partial
+* profiles are merged at the end.
 */
 
 #define _GNU_SOURCE
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <errno.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "profile.h"
+
+/*
+* Binary keys have no characters to group into classes, so instead we count,
+* for every bit of the record, how many records have it set. The variance of a
+* bit, p * (1 - p) with p = ones / records, is zero only when the bit is always
+* 0 or always 1. Every other bit goes into the mask printed for keysynth, one
+* byte at a time:
+*
+*                            --binary 00ff0f...
+*/
+static int profile_binary(const size_t record_size) {
+	unsigned char* record = malloc(record_size);
+	unsigned long* ones = calloc(record_size * 8, sizeof(*ones));
+
+	unsigned long record_count = 0;
+	size_t in_bytes;
+	while ((in_bytes = fread(record, 1, record_size, stdin)) == record_size) {
+		for (size_t i = 0; i < record_size; ++i) {
+			for (int bit = 0; bit < 8; ++bit) {
+				ones[i * 8 + bit] += (record[i] >> bit) & 1;
+			}
+		}
+		++record_count;
+	}
+	if (in_bytes != 0) {
+		fprintf(stderr, "WARNING: ignoring %zu trailing bytes, input is not a multiple of the record size!\n", in_bytes);
+	}
+	free(record);
+
+	if (record_count == 0) {
+		fprintf(stderr, "must send records in standard input!\n");
+		free(ones);
+		return 1;
+	}
+
+	printf("--binary ");
+	for (size_t i = 0; i < record_size; ++i) {
+		unsigned mask = 0;
+		for (int bit = 0; bit < 8; ++bit) {
+			const unsigned long count = ones[i * 8 + bit];
+			if (count != 0 && count != record_count) {
+				mask |= 1u << bit;
+			}
+		}
+		printf("%02x", mask);
+	}
+	puts("");
 
-typedef struct Range {
+	free(ones);
+	return 0;
+}
+
+/*
+* Keys like 10.0.0.1 and 192.168.100.200 have fields of different sizes, so
+* their bytes do not line up. Instead, we look for delimiters that appear the
+* same number of times, in the same order, in every line, and infer every
+* field between them on its own: the class of its characters, and the range
+* of its lengths:
+*
+*                 [0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}\.[0-9]{1,3}
+*                 --delimiters .
+*
+* The second line tells keysynth which characters split the fields.
+*/
+#define DELIMITER_CANDIDATES ".:-/"
+
+typedef struct Field {
 	char start;
 	char end;
-	unsigned long count[256];
-} Range;
-
-enum Class {
-	Class_Num = 0x1,
-	Class_Lowercase = 0x2,
-	Class_UpperCase = 0x4,
-	Class_Punct = 0x8,
-};
-
-static int range_class(const Range range) {
-	int class = 0;
-
-	if (range.start >= '0' && range.start <= '9')
-		class |= Class_Num;
-	else if (range.start >= 'A' && range.start <= 'Z')
-		class |= Class_UpperCase;
-	else if (range.start >= 'a' && range.start <= 'z')
-		class |= Class_Lowercase;
-	else
-		class |= Class_Punct;
-
-	if (range.end >= '0' && range.end <= '9')
-		class |= Class_Num;
-	else if (range.end >= 'A' && range.end <= 'Z')
-		class |= Class_UpperCase;
-	else if (range.end >= 'a' && range.end <= 'z')
-		class |= Class_Lowercase;
-	else
-		class |= Class_Punct;
-
-	return class;
-}
-
-static void print_class(const Range range) {
-	char start = 0;
-	char end = 127;
-
-	if (range.start >= '0' && range.start <= '9')
-		start = '0';
-	else if (range.start >= 'A' && range.start <= 'Z')
-		start = 'A';
-	else if (range.start >= 'a' && range.start <= 'z')
-		start = 'a';
-	else
-		start = '!';
-
-	if (range.end >= '0' && range.end <= '9')
-		end = '9';
-	else if (range.end >= 'A' && range.end <= 'Z')
-		end = 'Z';
-	else if (range.end >= 'a' && range.end <= 'z')
-		end = 'z';
-	else
-		end = '}';
-
-	printf("[%c-%c]", start, end);
-}
-
-static int is_special(const char ch) {
-	return ch == '\\'
-		|| ch == '['
-		|| ch == '{'
-		|| ch == ')'
-		|| ch == '('
-		|| ch == '+'
-		|| ch == '*'
-		|| ch == '?'
-		|| ch == '.';
+	size_t min_length;
+	size_t max_length;
+	int constant;
+} Field;
+
+static int is_delimiter(const char ch, const char* delimiters) {
+	return ch != '\0' && strchr(delimiters, ch) != NULL;
 }
 
-int main(int argc, const char* argv[]) {
+static int profile_tokens(void) {
+	char** lines = NULL;
+	size_t* sizes = NULL;
+	size_t line_count = 0;
+	size_t capacity = 0;
 
-	if (argc > 1) {
-		printf("keybuilder\n");
-		printf("\nDescription: keybuilder generates a regex from a series of strings separated by newlines\n");
-		printf("\nExample usage: `./keybuilder < keys.txt`\n");
-		printf("\nOptions:\n");
-		printf("\n    -h    Print this help\n");
-		printf("\n");
-		if (!(strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
-			fprintf(stderr, "ERROR: unrecognized argument: %s\n", argv[1]);
-			return 1;
-		} else {
-			return 0;
+	char* line = NULL;
+	size_t n;
+	ssize_t in_bytes;
+	while ((in_bytes = getline(&line, &n, stdin)) > -1) {
+		if (in_bytes > 0 && line[in_bytes - 1] == '\n') {
+			line[--in_bytes] = '\0';
+		}
+		if (line_count == capacity) {
+			capacity = capacity ? capacity * 2 : 1024;
+			lines = realloc(lines, capacity * sizeof(*lines));
+			sizes = realloc(sizes, capacity * sizeof(*sizes));
+		}
+		lines[line_count] = strdup(line);
+		sizes[line_count] = in_bytes;
+		++line_count;
+	}
+	free(line);
+
+	if (line_count == 0) {
+		fprintf(stderr, "must send strings in standard input!\n");
+		return 1;
+	}
+
+	// a delimiter is consistent if every line has it the same number of times
+	char delimiters[sizeof(DELIMITER_CANDIDATES)] = {0};
+	size_t num_delimiters = 0;
+	for (const char* candidate = DELIMITER_CANDIDATES; *candidate; ++candidate) {
+		size_t first_count = 0;
+		int consistent = 1;
+		for (size_t l = 0; l < line_count && consistent; ++l) {
+			size_t count = 0;
+			for (size_t i = 0; i < sizes[l]; ++i) {
+				count += lines[l][i] == *candidate;
+			}
+			first_count = l == 0 ? count : first_count;
+			consistent = count == first_count;
+		}
+		if (consistent && first_count > 0) {
+			delimiters[num_delimiters++] = *candidate;
+		}
+	}
+
+	int status = 0;
+	if (num_delimiters == 0) {
+		fprintf(stderr, "ERROR: no delimiter among \"%s\" appears the same number of times in every line!\n", DELIMITER_CANDIDATES);
+		status = 1;
+	} else {
+		// the fields are split by the delimiters of the first line, in order
+		size_t num_fields = 1;
+		for (size_t i = 0; i < sizes[0]; ++i) {
+			num_fields += is_delimiter(lines[0][i], delimiters);
+		}
+		char* sequence = calloc(num_fields, 1);
+		for (size_t i = 0, f = 0; i < sizes[0]; ++i) {
+			if (is_delimiter(lines[0][i], delimiters)) {
+				sequence[f++] = lines[0][i];
+			}
+		}
+		Field* fields = calloc(num_fields, sizeof(*fields));
+		char** first_tokens = calloc(num_fields, sizeof(*first_tokens));
+		size_t* first_sizes = calloc(num_fields, sizeof(*first_sizes));
+		size_t skipped = 0;
+
+		for (size_t l = 0; l < line_count; ++l) {
+			// lines whose delimiters come in another order do not fit the fields
+			int fits = 1;
+			for (size_t i = 0, f = 0; i < sizes[l] && fits; ++i) {
+				if (is_delimiter(lines[l][i], delimiters)) {
+					fits = lines[l][i] == sequence[f++];
+				}
+			}
+			if (!fits) {
+				++skipped;
+				continue;
+			}
+
+			size_t token_start = 0;
+			for (size_t f = 0; f < num_fields; ++f) {
+				size_t token_end = token_start;
+				while (token_end < sizes[l] && !is_delimiter(lines[l][token_end], delimiters)) {
+					++token_end;
+				}
+				const char* token = lines[l] + token_start;
+				const size_t length = token_end - token_start;
+				Field* field = &fields[f];
+				if (first_tokens[f] == NULL) {
+					first_tokens[f] = lines[l] + token_start;
+					first_sizes[f] = length;
+					field->min_length = length;
+					field->max_length = length;
+					field->constant = 1;
+				}
+				field->constant = field->constant && length == first_sizes[f] && memcmp(token, first_tokens[f], length) == 0;
+				field->min_length = length < field->min_length ? length : field->min_length;
+				field->max_length = length > field->max_length ? length : field->max_length;
+				for (size_t i = 0; i < length; ++i) {
+					if (field->start == 0 || token[i] < field->start)
+						field->start = token[i];
+					if (field->end == 0 || token[i] > field->end)
+						field->end = token[i];
+				}
+				token_start = token_end + 1;
+			}
 		}
+		if (skipped > 0) {
+			fprintf(stderr, "WARNING: ignoring %zu lines whose delimiters come in another order!\n", skipped);
+		}
+
+		for (size_t f = 0; f < num_fields; ++f) {
+			const Field field = fields[f];
+			if (field.constant) {
+				for (size_t i = 0; i < first_sizes[f]; ++i) {
+					if (is_special(first_tokens[f][i])) {
+						putchar('\\');
+					}
+					putchar(first_tokens[f][i]);
+				}
+			} else {
+				const Range range = { .start = field.start, .end = field.end };
+				print_class(stdout, range);
+				if (field.min_length != field.max_length) {
+					printf("{%zu,%zu}", field.min_length, field.max_length);
+				} else if (field.max_length > 1) {
+					printf("{%zu}", field.max_length);
+				}
+			}
+			if (f + 1 < num_fields) {
+				if (is_special(sequence[f])) {
+					putchar('\\');
+				}
+				putchar(sequence[f]);
+			}
+		}
+		puts("");
+		printf("--delimiters %s\n", delimiters);
+
+		free(first_sizes);
+		free(first_tokens);
+		free(fields);
+		free(sequence);
 	}
 
+	for (size_t l = 0; l < line_count; ++l) {
+		free(lines[l]);
+	}
+	free(lines);
+	free(sizes);
+	return status;
+}
+
+/*
+* Live key taps never end, so lines may also be read as a stream. Every
+* `window` lines, the ranges and the entropies, as printed, are compared with
+* the ones of the previous window, and reading stops once a whole window left
+* both unchanged. A reservoir (Algorithm R) keeps a uniform sample of the lines
+* read so far, in a fixed amount of memory, for collision tests downstream.
+*/
+typedef struct Stream {
+	size_t window;
+	size_t reservoir_size;
+	const char* reservoir_path;
+	char** reservoir;
+	size_t seen;
+	uint64_t random;
+	long* entropies;
+} Stream;
+
+static uint64_t next_random(uint64_t* state) {
+	// splitmix64
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static void sample_line(Stream* stream, const char* line, const size_t length) {
+	if (stream->reservoir_size == 0) {
+		return;
+	}
+	size_t slot = stream->seen++;
+	if (slot >= stream->reservoir_size) {
+		slot = next_random(&stream->random) % stream->seen;
+		if (slot >= stream->reservoir_size) {
+			return;
+		}
+	}
+	free(stream->reservoir[slot]);
+	stream->reservoir[slot] = strndup(line, length);
+}
+
+static int write_reservoir(const Stream* stream) {
+	FILE* file = fopen(stream->reservoir_path, "w");
+	if (file == NULL) {
+		fprintf(stderr, "ERROR: could not open %s: %s\n", stream->reservoir_path, strerror(errno));
+		return 1;
+	}
+	const size_t sampled = stream->seen < stream->reservoir_size ? stream->seen : stream->reservoir_size;
+	for (size_t i = 0; i < sampled; ++i) {
+		fprintf(file, "%s\n", stream->reservoir[i]);
+	}
+	if (fclose(file) != 0) {
+		fprintf(stderr, "ERROR: could not write %s\n", stream->reservoir_path);
+		return 1;
+	}
+	return 0;
+}
+
+// whether the entropies, as printed, are the same as in the previous window
+static int entropies_converged(Stream* stream, const Range* ranges, const size_t key_size, const size_t line_count) {
+	int converged = 1;
+	for (size_t i = 0; i < key_size; ++i) {
+		const long entropy = lround(position_entropy(&ranges[i], line_count) * 100);
+		converged = converged && entropy == stream->entropies[i];
+		stream->entropies[i] = entropy;
+	}
+	return converged;
+}
+
+/*
+* Positions past the longest line seen so far have no histograms yet. Lines
+* longer than MAX_PROFILED_WIDTH are only profiled up to it, since every
+* position takes a 2KiB histogram.
+*/
+#define MAX_PROFILED_WIDTH 4096
+
+static size_t profiled_width(const size_t length) {
+	return length < MAX_PROFILED_WIDTH ? length : MAX_PROFILED_WIDTH;
+}
+
+// add histograms for the positions up to width, which no line has reached yet
+static void widen_ranges(Profile* profile, char** previous, const size_t width) {
+	profile->ranges = realloc(profile->ranges, (width + 1) * sizeof(*profile->ranges));
+	reset_ranges(profile->ranges + profile->width, width - profile->width);
+	memset(profile->ranges + width, 0, sizeof(*profile->ranges));
+	*previous = realloc(*previous, width + 1);
+	profile->width = width;
+}
+
+static int profile_lines(Profile* profile, Stream* stream) {
 	char* line = NULL;
 	size_t n;
 
 	// begin by reading the first line
-	ssize_t line_size = getline(&line, &n, stdin);
-	if (line_size == -1) {
+	ssize_t in_bytes = getline(&line, &n, stdin);
+	if (in_bytes == -1) {
 		if (errno != 0) {
 			fprintf(stderr, "failed to read initial line from standard input: %s\n", strerror(errno));
 		} else {
@@ -132,64 +384,747 @@ int main(int argc, const char* argv[]) {
 		free(line);
 		return 1;
 	}
-
-	Range* ranges = malloc(line_size * sizeof(*ranges));
+	const size_t first_length = in_bytes - (line[in_bytes - 1] == '\n');
+	const size_t width = profiled_width(first_length);
 
 	// set the initial ranges, according to the first line
-	for (ssize_t i = 0; i < line_size - 1; ++i) {
-		ranges[i].start = line[i];
-		ranges[i].end = line[i];
+	profile->width = width;
+	profile->ranges = calloc(width + 1, sizeof(*profile->ranges));
+	reset_ranges(profile->ranges, width);
+	add_line(profile, line, first_length, NULL, 0);
+	char* previous = malloc(width + 1);
+	memcpy(previous, line, width);
+	size_t previous_length = width;
+
+	count_length(&profile->length_count, &profile->max_length, first_length, 1);
+	sample_line(stream, line, first_length);
+	if (stream->window) {
+		stream->entropies = malloc((width + 1) * sizeof(*stream->entropies));
+		for (size_t i = 0; i < width; ++i) {
+			stream->entropies[i] = -1;
+		}
 	}
+	size_t last_change = 0;
 
 
 	// now, read every line, while updating the ranges. We assume all
-	// lines have the same size, and exit with an error if they don't
-	ssize_t in_bytes;
-	ssize_t line_count = 1;
+	// lines have the same size, and only keep the positions of the
+	// shortest one if they don't. Positions of the longest line that are
+	// past the shortest one are still counted, for outlier tolerance
 	while ((in_bytes = getline(&line, &n, stdin)) > -1) {
-		if (in_bytes != line_size) {
-			fprintf(stderr, "WARNING: lines have different size!\n");
+		const size_t length = in_bytes - (in_bytes > 0 && line[in_bytes - 1] == '\n');
+		if (profiled_width(length) > profile->width) {
+			widen_ranges(profile, &previous, profiled_width(length));
 		}
-		line_size = line_size < in_bytes ? line_size : in_bytes;
+		count_length(&profile->length_count, &profile->max_length, length, 1);
+		sample_line(stream, line, length);
+		const int changed = add_line(profile, line, length, previous, previous_length);
 
-		for (ssize_t i = 0; i < line_size - 1; ++i) {
-			ranges[i].start = line[i] < ranges[i].start ? line[i] : ranges[i].start;
-			ranges[i].end = line[i] > ranges[i].end ? line[i] : ranges[i].end;
-			ranges[i].count[line[i]]++;
-		}
+		previous_length = profiled_width(length);
+		memcpy(previous, line, previous_length);
 
-		++line_count;
+		const size_t line_count = profile->line_count;
+		last_change = changed ? line_count : last_change;
+		if (stream->window && line_count % stream->window == 0) {
+			const int converged = entropies_converged(stream, profile->ranges, profile->key_size, line_count);
+			if (converged && line_count - last_change >= stream->window) {
+				fprintf(stderr, "converged after %zu lines\n", line_count);
+				break;
+			}
+		}
 	}
+	free(stream->entropies);
+	free(previous);
 	free(line);
-	line = NULL;
-
-	// finally, group consecutive identical ranges together. For example,
-	// `[0-9][0-9][0-9]` will turn into `[0-9]{3}`
-	ssize_t i = 0;
-	while (i < line_size - 1) {
-		const Range range = ranges[i++];
-		if (range.start == range.end) {
-			if (is_special(range.start)) {
-				putchar('\\');
-			}
-			putchar(range.start);
+	return 0;
+}
+
+/*
+* A thread profiles the lines in [begin, end) of the mapped input. Positions
+* are padded to a multiple of 32 bytes, so rows are loaded 32 bytes at a time.
+* The bytes loaded past the end of a row belong to the next rows, and only land
+* in positions that are dropped, since the profile is cut to the shortest line.
+*/
+#define PROFILE_VECTOR 32
+
+typedef struct Partial {
+	const char* begin;
+	const char* end;
+	const char* map_end;
+	size_t key_size;
+	size_t width;
+	signed char* min;
+	signed char* max;
+	unsigned char* or_mask;
+	unsigned char* and_mask;
+	unsigned long* count;
+	unsigned long* changes;
+	size_t min_size;
+	size_t line_count;
+	size_t max_length;
+	unsigned long* length_count;
+} Partial;
+
+static void profile_row(Partial* partial, const char* row, const size_t row_size) {
+	char buffer[PROFILE_VECTOR];
+	const size_t width = partial->width;
+	for (size_t i = 0; i < width; i += PROFILE_VECTOR) {
+		const char* bytes = row + i;
+		// near the end of the mapping, the row is copied so it is never read past the end
+		if (partial->map_end - bytes < PROFILE_VECTOR) {
+			const ptrdiff_t available = partial->map_end - bytes;
+			memset(buffer, 0, sizeof(buffer));
+			if (available > 0) {
+				memcpy(buffer, bytes, available);
+			}
+			bytes = buffer;
+		}
+#ifdef __AVX2__
+		const __m256i chars = _mm256_loadu_si256((const __m256i*)bytes);
+		__m256i* min = (__m256i*)(partial->min + i);
+		__m256i* max = (__m256i*)(partial->max + i);
+		__m256i* or_mask = (__m256i*)(partial->or_mask + i);
+		__m256i* and_mask = (__m256i*)(partial->and_mask + i);
+		_mm256_store_si256(min, _mm256_min_epi8(_mm256_load_si256(min), chars));
+		_mm256_store_si256(max, _mm256_max_epi8(_mm256_load_si256(max), chars));
+		_mm256_store_si256(or_mask, _mm256_or_si256(_mm256_load_si256(or_mask), chars));
+		_mm256_store_si256(and_mask, _mm256_and_si256(_mm256_load_si256(and_mask), chars));
+#else
+		for (size_t j = 0; j < PROFILE_VECTOR; ++j) {
+			const signed char ch = bytes[j];
+			partial->min[i + j] = ch < partial->min[i + j] ? ch : partial->min[i + j];
+			partial->max[i + j] = ch > partial->max[i + j] ? ch : partial->max[i + j];
+			partial->or_mask[i + j] |= ch;
+			partial->and_mask[i + j] &= ch;
+		}
+#endif
+	}
+
+	const size_t positions = row_size < partial->key_size ? row_size : partial->key_size;
+	for (size_t i = 0; i < positions; ++i) {
+		partial->count[i * 256 + (unsigned char)row[i]]++;
+	}
+}
+
+// copy a vector of positions into a wider one, whose new positions are filled
+static void* widen_vector(void* vector, const size_t width, const size_t new_width, const int fill) {
+	void* wider = aligned_alloc(PROFILE_VECTOR, new_width + PROFILE_VECTOR);
+	memset(wider, fill, new_width + PROFILE_VECTOR);
+	memcpy(wider, vector, width);
+	free(vector);
+	return wider;
+}
+
+// add histograms for the positions up to key_size, which no row of the partial has reached yet
+static void widen_partial(Partial* partial, const size_t key_size) {
+	const size_t width = (key_size + PROFILE_VECTOR - 1) / PROFILE_VECTOR * PROFILE_VECTOR;
+	if (width > partial->width) {
+		partial->min = widen_vector(partial->min, partial->width, width, 127);
+		partial->max = widen_vector(partial->max, partial->width, width, -128);
+		partial->or_mask = widen_vector(partial->or_mask, partial->width, width, 0);
+		partial->and_mask = widen_vector(partial->and_mask, partial->width, width, 0xff);
+		partial->width = width;
+	}
+	partial->count = realloc(partial->count, (key_size * 256 + 1) * sizeof(*partial->count));
+	memset(partial->count + partial->key_size * 256, 0, ((key_size - partial->key_size) * 256 + 1) * sizeof(*partial->count));
+	partial->changes = realloc(partial->changes, (key_size + 1) * sizeof(*partial->changes));
+	memset(partial->changes + partial->key_size, 0, (key_size - partial->key_size + 1) * sizeof(*partial->changes));
+	partial->key_size = key_size;
+}
+
+static void* profile_chunk(void* arg) {
+	Partial* partial = arg;
+	const char* row = partial->begin;
+	const char* previous = NULL;
+	size_t previous_size = 0;
+	while (row < partial->end) {
+		const char* newline = memchr(row, '\n', partial->end - row);
+		const char* row_end = newline ? newline : partial->end;
+		const size_t row_size = row_end - row;
+		if (profiled_width(row_size) > partial->key_size) {
+			widen_partial(partial, profiled_width(row_size));
+		}
+
+		// the first row of a chunk has no previous row, which only misses one change per thread
+		size_t positions = row_size < previous_size ? row_size : previous_size;
+		positions = positions < partial->key_size ? positions : partial->key_size;
+		for (size_t i = 0; previous && i < positions; ++i) {
+			partial->changes[i] += row[i] != previous[i];
+		}
+		previous = row;
+		previous_size = row_size;
+
+		count_length(&partial->length_count, &partial->max_length, row_size, 1);
+		if (partial->line_count == 0 || row_size < partial->min_size) {
+			partial->min_size = row_size;
+		}
+		profile_row(partial, row, row_size);
+		++partial->line_count;
+		row = row_end + 1;
+	}
+	return NULL;
+}
+
+static int profile_mapped(const size_t input_size, size_t num_threads, Profile* profile) {
+	void* mapped = mmap(NULL, input_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+	if (mapped == MAP_FAILED) {
+		fprintf(stderr, "failed to map standard input: %s\n", strerror(errno));
+		return 1;
+	}
+	madvise(mapped, input_size, MADV_SEQUENTIAL);
+	const char* data = mapped;
+	const char* data_end = data + input_size;
+
+	// the first line sets the positions that are profiled, until a longer one widens them
+	const char* first_newline = memchr(data, '\n', input_size);
+	const size_t key_size = profiled_width(first_newline ? (size_t)(first_newline - data) : input_size);
+	const size_t width = (key_size + PROFILE_VECTOR - 1) / PROFILE_VECTOR * PROFILE_VECTOR;
+
+	if (num_threads > input_size / (1 << 20) + 1) {
+		num_threads = input_size / (1 << 20) + 1;
+	}
+	Partial* partials = calloc(num_threads, sizeof(*partials));
+	pthread_t* threads = calloc(num_threads, sizeof(*threads));
+
+	// every chunk starts right after a newline, so no line is split
+	const char* begin = data;
+	for (size_t t = 0; t < num_threads; ++t) {
+		const char* end = data + input_size / num_threads * (t + 1);
+		if (t + 1 == num_threads || end <= begin) {
+			end = t + 1 == num_threads ? data_end : begin;
 		} else {
-			int repetitions = 1;
-			Range other = ranges[i++];
-			while (range_class(range) == range_class(other)) {
-				other = ranges[i++];
-				++repetitions;
+			const char* newline = memchr(end - 1, '\n', data_end - (end - 1));
+			end = newline ? newline + 1 : data_end;
+		}
+
+		Partial* partial = &partials[t];
+		partial->begin = begin;
+		partial->end = end;
+		partial->map_end = data_end;
+		partial->key_size = key_size;
+		partial->width = width;
+		partial->min = aligned_alloc(PROFILE_VECTOR, width + PROFILE_VECTOR);
+		partial->max = aligned_alloc(PROFILE_VECTOR, width + PROFILE_VECTOR);
+		partial->or_mask = aligned_alloc(PROFILE_VECTOR, width + PROFILE_VECTOR);
+		partial->and_mask = aligned_alloc(PROFILE_VECTOR, width + PROFILE_VECTOR);
+		partial->count = calloc(key_size * 256 + 1, sizeof(*partial->count));
+		partial->changes = calloc(key_size + 1, sizeof(*partial->changes));
+		memset(partial->min, 127, width + PROFILE_VECTOR);
+		memset(partial->max, -128, width + PROFILE_VECTOR);
+		memset(partial->or_mask, 0, width + PROFILE_VECTOR);
+		memset(partial->and_mask, 0xff, width + PROFILE_VECTOR);
+		begin = end;
+
+		if (t > 0 && pthread_create(&threads[t], NULL, profile_chunk, partial) != 0) {
+			profile_chunk(partial);
+			threads[t] = 0;
+		}
+	}
+	profile_chunk(&partials[0]);
+
+	// merge the partial profiles of every thread into the first one
+	Partial* merged = &partials[0];
+	for (size_t t = 1; t < num_threads; ++t) {
+		if (threads[t]) {
+			pthread_join(threads[t], NULL);
+		}
+		Partial* partial = &partials[t];
+		if (partial->line_count == 0) {
+			continue;
+		}
+		for (size_t length = 0; length <= partial->max_length; ++length) {
+			if (partial->length_count[length] != 0) {
+				count_length(&merged->length_count, &merged->max_length, length, partial->length_count[length]);
 			}
+		}
+		if (merged->line_count == 0 || partial->min_size < merged->min_size) {
+			merged->min_size = partial->min_size;
+		}
+		merged->line_count += partial->line_count;
+		if (partial->key_size > merged->key_size) {
+			widen_partial(merged, partial->key_size);
+		}
+		for (size_t i = 0; i < partial->width; ++i) {
+			merged->min[i] = partial->min[i] < merged->min[i] ? partial->min[i] : merged->min[i];
+			merged->max[i] = partial->max[i] > merged->max[i] ? partial->max[i] : merged->max[i];
+			merged->or_mask[i] |= partial->or_mask[i];
+			merged->and_mask[i] &= partial->and_mask[i];
+		}
+		for (size_t i = 0; i < partial->key_size * 256; ++i) {
+			merged->count[i] += partial->count[i];
+		}
+		for (size_t i = 0; i < partial->key_size; ++i) {
+			merged->changes[i] += partial->changes[i];
+		}
+	}
+
+	profile->key_size = merged->min_size < merged->key_size ? merged->min_size : merged->key_size;
+	profile->line_count = merged->line_count;
+	profile->max_length = merged->max_length;
+	profile->length_count = merged->length_count;
+	merged->length_count = NULL;
+	profile->width = merged->key_size;
+	profile->ranges = calloc(profile->width + 1, sizeof(*profile->ranges));
+	for (size_t i = 0; i < profile->width; ++i) {
+		profile->ranges[i].start = merged->min[i];
+		profile->ranges[i].end = merged->max[i];
+		profile->ranges[i].or_mask = merged->or_mask[i];
+		profile->ranges[i].and_mask = merged->and_mask[i];
+		memcpy(profile->ranges[i].count, merged->count + i * 256, sizeof(profile->ranges[i].count));
+		profile->ranges[i].changes = merged->changes[i];
+	}
+
+	for (size_t t = 0; t < num_threads; ++t) {
+		free(partials[t].min);
+		free(partials[t].max);
+		free(partials[t].or_mask);
+		free(partials[t].and_mask);
+		free(partials[t].count);
+		free(partials[t].changes);
+		free(partials[t].length_count);
+	}
+	free(threads);
+	free(partials);
+	munmap(mapped, input_size);
+	return 0;
+}
+
+/*
+* One malformed key widens a range forever: a single letter in a column of
+* digits turns its [0-9] into [0-z]. With a tolerance of x% of the lines, the
+* rarest symbols of every position, and the rarest line lengths, whose counts
+* add up to at most x% of the lines, are outliers. The ranges and masks only
+* keep the other symbols, and the layout is marked as guarded, so keysynth
+* emits a hash function that checks the keys conform to it, and falls back to
+* a generic hash function for the ones that do not.
+*/
+typedef struct Outliers {
+	double percent;
+	unsigned char* kept;
+	unsigned char* kept_length;
+	size_t key_size;
+	unsigned long dropped;
+} Outliers;
+
+// flag the values of the histogram that are kept, and return the dropped count
+static unsigned long drop_rarest(const unsigned long* counts, const size_t size, const unsigned long budget, unsigned char* kept) {
+	size_t* order = malloc(size * sizeof(*order));
+	size_t num_values = 0;
+	for (size_t value = 0; value < size; ++value) {
+		kept[value] = counts[value] != 0;
+		if (counts[value] == 0) {
+			continue;
+		}
+		// insertion sort, rarest first
+		size_t i = num_values++;
+		while (i > 0 && counts[order[i - 1]] > counts[value]) {
+			order[i] = order[i - 1];
 			--i;
+		}
+		order[i] = value;
+	}
+
+	unsigned long dropped = 0;
+	for (size_t i = 0; i + 1 < num_values && dropped + counts[order[i]] <= budget; ++i) {
+		dropped += counts[order[i]];
+		kept[order[i]] = 0;
+	}
+	free(order);
+	return dropped;
+}
+
+static void apply_outliers(Profile* profile, Outliers* outliers) {
+	const unsigned long budget = outliers->percent / 100.0 * profile->line_count;
 
-			print_class(range);
-			if (repetitions > 1) {
-				printf("{%d}", repetitions);
+	outliers->kept_length = malloc(profile->max_length + 1);
+	outliers->dropped = drop_rarest(profile->length_count, profile->max_length + 1, budget, outliers->kept_length);
+	size_t key_size = profile->width;
+	for (size_t length = 0; length <= profile->max_length; ++length) {
+		if (outliers->kept_length[length]) {
+			key_size = length < key_size ? length : key_size;
+		} else {
+			profile->length_count[length] = 0;
+		}
+	}
+
+	outliers->key_size = key_size;
+	outliers->kept = malloc(key_size * 256 + 1);
+	for (size_t i = 0; i < key_size; ++i) {
+		Range* range = &profile->ranges[i];
+		unsigned char* kept = outliers->kept + i * 256;
+		outliers->dropped += drop_rarest(range->count, 256, budget, kept);
+
+		int first = 1;
+		for (int ch = 0; ch < 256; ++ch) {
+			if (!kept[ch]) {
+				continue;
 			}
+			const char symbol = ch;
+			range->start = first || symbol < range->start ? symbol : range->start;
+			range->end = first || symbol > range->end ? symbol : range->end;
+			range->or_mask = first ? symbol : range->or_mask | symbol;
+			range->and_mask = first ? symbol : range->and_mask & symbol;
+			first = 0;
 		}
 	}
-	puts("");
 
-	free(ranges);
+	profile->key_size = key_size;
+	profile->guarded = outliers->dropped > 0;
+}
+
+static int is_outlier(const Outliers* outliers, const char* line, const size_t length) {
+	if (!outliers->kept_length[length]) {
+		return 1;
+	}
+	for (size_t i = 0; i < outliers->key_size; ++i) {
+		if (!outliers->kept[i * 256 + (unsigned char)line[i]]) {
+			return 1;
+		}
+	}
 	return 0;
 }
+
+/*
+* The lines of a mapped input are read again to find the outliers. A pipe
+* cannot be read again, so the outliers are looked up in the reservoir, which
+* is a uniform sample of it. Without a reservoir, only the sum of the outlier
+* counts is known, which counts a line once per rare symbol it has.
+*/
+#define MAX_REPORTED_OUTLIERS 10
+
+static size_t check_outlier(const Profile* profile, const Outliers* outliers, const char* line, const size_t length,
+	const size_t num_outliers) {
+	if (length > profile->max_length || !is_outlier(outliers, line, length)) {
+		return num_outliers;
+	}
+	if (num_outliers < MAX_REPORTED_OUTLIERS) {
+		fprintf(stderr, "outlier: %.*s\n", (int)length, line);
+	}
+	return num_outliers + 1;
+}
+
+static void report_outliers(const Profile* profile, const Outliers* outliers, const size_t input_size,
+	const Stream* stream) {
+	const size_t sampled = stream->seen < stream->reservoir_size ? stream->seen : stream->reservoir_size;
+	if (input_size == 0 && sampled == 0) {
+		fprintf(stderr, "WARNING: at most %lu of %zu keys (%.4f%%) are outliers, the layout is guarded\n",
+			outliers->dropped, profile->line_count, 100.0 * outliers->dropped / profile->line_count);
+		fprintf(stderr, "WARNING: keys with several rare symbols are counted once per symbol, "
+			"read an input file or use --reservoir to list the outliers\n");
+		return;
+	}
+
+	size_t num_outliers = 0;
+	if (input_size == 0) {
+		for (size_t i = 0; i < sampled; ++i) {
+			num_outliers = check_outlier(profile, outliers, stream->reservoir[i], strlen(stream->reservoir[i]),
+				num_outliers);
+		}
+		fprintf(stderr, "WARNING: %zu of %zu sampled keys (%.4f%%) are outliers, the layout is guarded\n",
+			num_outliers, sampled, 100.0 * num_outliers / sampled);
+		return;
+	}
+
+	void* mapped = mmap(NULL, input_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0);
+	if (mapped == MAP_FAILED) {
+		return;
+	}
+	const char* row = mapped;
+	const char* data_end = row + input_size;
+	while (row < data_end) {
+		const char* newline = memchr(row, '\n', data_end - row);
+		const char* row_end = newline ? newline : data_end;
+		num_outliers = check_outlier(profile, outliers, row, row_end - row, num_outliers);
+		row = row_end + 1;
+	}
+	munmap(mapped, input_size);
+	fprintf(stderr, "WARNING: %zu of %zu keys (%.4f%%) are outliers, the layout is guarded\n",
+		num_outliers, profile->line_count, 100.0 * num_outliers / profile->line_count);
+}
+
+/*
+* Some positions are functions of the others, like the check digits of a CPF,
+* so hashing them adds no distinctness. Position i is determined by the others
+* if H(X_i | X_others) is zero on the sample: no two distinct keys agree on
+* every other position. Since distinct keys rarely agree on every other
+* position of a sparse sample anyway, this only counts as evidence if keys with
+* independent positions would be expected to agree often. The chance that two
+* of them agree on position j is q_j = sum(p_j(x)^2), from the histograms, so
+* about N^2 / 2 * prod(q_j, j != i) * (1 - q_i) pairs of the N distinct keys
+* would agree everywhere but i. The positions are tested from the last one, as
+* check digits usually come last, and the other positions only include the ones
+* that are not redundant yet, so the redundant positions are all determined by
+* the remaining ones together.
+*/
+#define REDUNDANCY_MIN_EXPECTED 16.0
+#define REDUNDANCY_MAX_KEYS (1 << 22)
+
+typedef struct Projection {
+	uint64_t others;
+	uint64_t key;
+} Projection;
+
+static int compare_projections(const void* a, const void* b) {
+	const Projection* x = a;
+	const Projection* y = b;
+	if (x->others != y->others) {
+		return x->others < y->others ? -1 : 1;
+	}
+	return (x->key > y->key) - (x->key < y->key);
+}
+
+static uint64_t hash_positions(const char* key, const unsigned char* used, const size_t key_size) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (size_t i = 0; i < key_size; ++i) {
+		if (used[i]) {
+			hash = (hash ^ (unsigned char)key[i]) * 0x100000001b3ULL;
+			hash ^= hash >> 29;
+		}
+	}
+	return hash;
+}
+
+static void find_redundant(Profile* profile, const char** keys, const size_t num_keys) {
+	const size_t key_size = profile->key_size;
+	profile->redundant = calloc(key_size + 1, 1);
+	unsigned char* used = malloc(key_size + 1);
+	Projection* projections = malloc((num_keys + 1) * sizeof(*projections));
+	for (size_t i = 0; i < key_size; ++i) {
+		used[i] = profile->ranges[i].start != profile->ranges[i].end;
+	}
+
+	// distinct keys, since duplicated keys always agree
+	for (size_t k = 0; k < num_keys; ++k) {
+		projections[k].others = hash_positions(keys[k], used, key_size);
+		projections[k].key = 0;
+	}
+	qsort(projections, num_keys, sizeof(*projections), compare_projections);
+	size_t distinct = num_keys > 0;
+	for (size_t k = 1; k < num_keys; ++k) {
+		distinct += projections[k].others != projections[k - 1].others;
+	}
+
+	for (size_t i = key_size; i-- > 0;) {
+		if (!used[i]) {
+			continue;
+		}
+		double expected = 0.5 * distinct * distinct * (1.0 - position_agreement(&profile->ranges[i], profile->line_count));
+		for (size_t j = 0; j < key_size; ++j) {
+			if (used[j] && j != i) {
+				expected *= position_agreement(&profile->ranges[j], profile->line_count);
+			}
+		}
+		if (expected < REDUNDANCY_MIN_EXPECTED) {
+			continue;
+		}
+
+		used[i] = 0;
+		for (size_t k = 0; k < num_keys; ++k) {
+			projections[k].others = hash_positions(keys[k], used, key_size);
+			projections[k].key = (projections[k].others << 8 | (projections[k].others >> 56)) ^ (unsigned char)keys[k][i];
+		}
+		used[i] = 1;
+		qsort(projections, num_keys, sizeof(*projections), compare_projections);
+		size_t agreeing = 0;
+		for (size_t k = 1; k < num_keys; ++k) {
+			agreeing += projections[k].others == projections[k - 1].others && projections[k].key != projections[k - 1].key;
+		}
+		if (agreeing == 0) {
+			profile->redundant[i] = 1;
+			used[i] = 0;
+		}
+	}
+	free(projections);
+	free(used);
+}
+
+// the keys of the profile's size, from the mapped input or from the reservoir
+static const char** collect_keys(const Profile* profile, const char* data, const size_t size,
+	char* const* reservoir, const size_t reservoir_size, size_t* num_keys) {
+	const char** keys = malloc(REDUNDANCY_MAX_KEYS * sizeof(*keys));
+	*num_keys = 0;
+	if (data) {
+		const char* row = data;
+		while (row < data + size && *num_keys < REDUNDANCY_MAX_KEYS) {
+			const char* newline = memchr(row, '\n', data + size - row);
+			const char* row_end = newline ? newline : data + size;
+			if ((size_t)(row_end - row) == profile->key_size) {
+				keys[(*num_keys)++] = row;
+			}
+			row = row_end + 1;
+		}
+	}
+	for (size_t i = 0; i < reservoir_size && reservoir[i] && *num_keys < REDUNDANCY_MAX_KEYS; ++i) {
+		if (strlen(reservoir[i]) == profile->key_size) {
+			keys[(*num_keys)++] = reservoir[i];
+		}
+	}
+	return keys;
+}
+
+static void print_help(void) {
+	printf("keybuilder\n");
+	printf("\nDescription: keybuilder generates a regex from a series of strings separated by newlines\n");
+	printf("\nExample usage: `./keybuilder < keys.txt`\n");
+	printf("\nOptions:\n");
+	printf("\n    -h    Print this help\n");
+	printf("\n    -b, --binary <size>    Read fixed size binary records of <size> bytes instead of lines,\n");
+	printf("                           and print the mask of the bits that vary across them\n");
+	printf("\n    -j, --threads <n>      Threads that profile a memory mapped input file (default: one per CPU)\n");
+	printf("\n    -p, --profile <file>   Write the profile of the lines to <file> instead of printing the regex\n");
+	printf("\n    -m, --merge <files>    Merge the profiles in <files>, written by --profile, instead of reading lines,\n");
+	printf("                           and print the regex of all their lines, or write it with --profile\n");
+	printf("\n    -s, --stream <window>  Stop reading once the ranges and the entropies did not change for <window> lines\n");
+	printf("\n    -r, --reservoir <k> <file>\n");
+	printf("                           Write a uniform sample of <k> of the lines read to <file>\n");
+	printf("\n    -x, --outliers <percent>\n");
+	printf("                           Ignore the rarest symbols of every position, and the rarest line lengths, that\n");
+	printf("                           add up to <percent>%% of the lines, report the keys that have them, and mark the\n");
+	printf("                           layout as guarded, so keysynth checks that keys conform to it. The keys are\n");
+	printf("                           listed from an input file, or from the --reservoir of a pipe\n");
+	printf("\n    -d, --redundant        Find the positions that are determined by the others, such as check digits,\n");
+	printf("                           so keysynth does not hash them. Needs an input file or a --reservoir\n");
+	printf("\n    -t, --tokenize         Split lines of different sizes at the delimiters they share (%s),\n", DELIMITER_CANDIDATES);
+	printf("                           and print a regex with the class and the length range of every field\n");
+	printf("\n");
+}
+
+int main(int argc, const char* argv[]) {
+
+	size_t record_size = 0;
+	int tokenize = 0;
+	const char* profile_path = NULL;
+	Stream stream = {0};
+	Outliers outliers = {0};
+	int redundant = 0;
+	const char* merge_paths[argc];
+	size_t num_merges = 0;
+	long num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+	for (int arg = 1; arg < argc; ++arg) {
+		if (strcmp(argv[arg], "-h") == 0 || strcmp(argv[arg], "--help") == 0) {
+			print_help();
+			return 0;
+		} else if ((strcmp(argv[arg], "-b") == 0 || strcmp(argv[arg], "--binary") == 0) && arg + 1 < argc) {
+			record_size = strtoul(argv[++arg], NULL, 10);
+			if (record_size == 0) {
+				fprintf(stderr, "ERROR: invalid record size: %s\n", argv[arg]);
+				return 1;
+			}
+		} else if ((strcmp(argv[arg], "-j") == 0 || strcmp(argv[arg], "--threads") == 0) && arg + 1 < argc) {
+			num_threads = strtol(argv[++arg], NULL, 10);
+			if (num_threads <= 0) {
+				fprintf(stderr, "ERROR: invalid number of threads: %s\n", argv[arg]);
+				return 1;
+			}
+		} else if ((strcmp(argv[arg], "-p") == 0 || strcmp(argv[arg], "--profile") == 0) && arg + 1 < argc) {
+			profile_path = argv[++arg];
+		} else if (strcmp(argv[arg], "-m") == 0 || strcmp(argv[arg], "--merge") == 0) {
+			while (arg + 1 < argc && argv[arg + 1][0] != '-') {
+				merge_paths[num_merges++] = argv[++arg];
+			}
+		} else if ((strcmp(argv[arg], "-s") == 0 || strcmp(argv[arg], "--stream") == 0) && arg + 1 < argc) {
+			stream.window = strtoul(argv[++arg], NULL, 10);
+			if (stream.window == 0) {
+				fprintf(stderr, "ERROR: invalid window: %s\n", argv[arg]);
+				return 1;
+			}
+		} else if ((strcmp(argv[arg], "-r") == 0 || strcmp(argv[arg], "--reservoir") == 0) && arg + 2 < argc) {
+			stream.reservoir_size = strtoul(argv[++arg], NULL, 10);
+			stream.reservoir_path = argv[++arg];
+			if (stream.reservoir_size == 0) {
+				fprintf(stderr, "ERROR: invalid reservoir size: %s\n", argv[arg - 1]);
+				return 1;
+			}
+		} else if ((strcmp(argv[arg], "-x") == 0 || strcmp(argv[arg], "--outliers") == 0) && arg + 1 < argc) {
+			outliers.percent = strtod(argv[++arg], NULL);
+			if (outliers.percent <= 0.0 || outliers.percent >= 100.0) {
+				fprintf(stderr, "ERROR: invalid outlier percentage: %s\n", argv[arg]);
+				return 1;
+			}
+		} else if (strcmp(argv[arg], "-d") == 0 || strcmp(argv[arg], "--redundant") == 0) {
+			redundant = 1;
+		} else if (strcmp(argv[arg], "-t") == 0 || strcmp(argv[arg], "--tokenize") == 0) {
+			tokenize = 1;
+		} else {
+			print_help();
+			fprintf(stderr, "ERROR: unrecognized argument: %s\n", argv[arg]);
+			return 1;
+		}
+	}
+
+	if (record_size != 0) {
+		return profile_binary(record_size);
+	}
+	if (tokenize) {
+		return profile_tokens();
+	}
+
+	Profile profile = {0};
+	struct stat input_stat;
+	size_t mapped_size = 0;
+	int status = 0;
+	if (num_merges > 0) {
+		for (size_t m = 0; m < num_merges && status == 0; ++m) {
+			Profile other = {0};
+			status = read_profile(&other, merge_paths[m]);
+			if (status == 0) {
+				merge_profile(&profile, &other);
+			}
+			free(other.ranges);
+			free(other.length_count);
+		}
+	} else if (stream.window == 0 && stream.reservoir_size == 0 && fstat(STDIN_FILENO, &input_stat) == 0
+		&& S_ISREG(input_stat.st_mode) && input_stat.st_size > 0) {
+		status = profile_mapped(input_stat.st_size, num_threads > 0 ? num_threads : 1, &profile);
+		mapped_size = input_stat.st_size;
+	} else {
+		// streams are read in order, so they stop early, and are sampled, exactly like a pipe
+		stream.reservoir = calloc(stream.reservoir_size + 1, sizeof(*stream.reservoir));
+		status = profile_lines(&profile, &stream);
+		if (status == 0 && stream.reservoir_size) {
+			status = write_reservoir(&stream);
+		}
+	}
+	// a profile written to a file keeps its outliers, so it can still be merged
+	if (status == 0 && outliers.percent > 0.0 && !profile_path) {
+		apply_outliers(&profile, &outliers);
+		if (profile.guarded) {
+			report_outliers(&profile, &outliers, mapped_size, &stream);
+		}
+		free(outliers.kept);
+		free(outliers.kept_length);
+	}
+	if (status == 0 && redundant && !profile_path) {
+		if (mapped_size == 0 && stream.reservoir_size == 0) {
+			fprintf(stderr, "WARNING: --redundant needs an input file or a --reservoir, no position is redundant\n");
+		} else {
+			void* mapped = mapped_size ? mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, STDIN_FILENO, 0) : NULL;
+			size_t num_keys;
+			const char** keys = collect_keys(&profile, mapped == MAP_FAILED ? NULL : mapped, mapped_size,
+				stream.reservoir, stream.reservoir_size, &num_keys);
+			find_redundant(&profile, keys, num_keys);
+			free(keys);
+			if (mapped && mapped != MAP_FAILED) {
+				munmap(mapped, mapped_size);
+			}
+		}
+	}
+	if (status == 0) {
+		if (profile_path) {
+			status = write_profile(&profile, profile_path);
+		} else {
+			if (count_lengths(&profile) > 1) {
+				fprintf(stderr, "WARNING: lines have different size! Try --tokenize for delimited fields.\n");
+			}
+			print_profile(stdout, &profile);
+		}
+	}
+	for (size_t i = 0; stream.reservoir && i < stream.reservoir_size; ++i) {
+		free(stream.reservoir[i]);
+	}
+	free(stream.reservoir);
+	free(profile.ranges);
+	free(profile.length_count);
+	free(profile.redundant);
+	return status;
+}
@@ -0,0 +1,433 @@
+/*
+* The profile of a set of keys: the range, the observed bits, the histogram,
+* and the velocity of every position, and the histogram of the line lengths.
+* Profiles are built from lines read by keybuilder, or from keys added through
+* the embeddable API in keybuilder.h, printed as a regex for keysynth, and
+* written to files that merge into the profile of all their keys.
+*/
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+
+#include "profile.h"
+
+void count_length(unsigned long** length_count, size_t* max_length, const size_t length, const unsigned long count) {
+	if (*length_count == NULL || length > *max_length) {
+		const size_t old_size = *length_count ? *max_length + 1 : 0;
+		*length_count = realloc(*length_count, (length + 1) * sizeof(**length_count));
+		memset(*length_count + old_size, 0, (length + 1 - old_size) * sizeof(**length_count));
+		*max_length = length;
+	}
+	(*length_count)[length] += count;
+}
+
+enum Class {
+	Class_Num = 0x1,
+	Class_Lowercase = 0x2,
+	Class_UpperCase = 0x4,
+	Class_Punct = 0x8,
+};
+
+int range_class(const Range range) {
+	int class = 0;
+
+	if (range.start >= '0' && range.start <= '9')
+		class |= Class_Num;
+	else if (range.start >= 'A' && range.start <= 'Z')
+		class |= Class_UpperCase;
+	else if (range.start >= 'a' && range.start <= 'z')
+		class |= Class_Lowercase;
+	else
+		class |= Class_Punct;
+
+	if (range.end >= '0' && range.end <= '9')
+		class |= Class_Num;
+	else if (range.end >= 'A' && range.end <= 'Z')
+		class |= Class_UpperCase;
+	else if (range.end >= 'a' && range.end <= 'z')
+		class |= Class_Lowercase;
+	else
+		class |= Class_Punct;
+
+	return class;
+}
+
+void print_class(FILE* out, const Range range) {
+	char start = 0;
+	char end = 127;
+
+	if (range.start >= '0' && range.start <= '9')
+		start = '0';
+	else if (range.start >= 'A' && range.start <= 'Z')
+		start = 'A';
+	else if (range.start >= 'a' && range.start <= 'z')
+		start = 'a';
+	else
+		start = '!';
+
+	if (range.end >= '0' && range.end <= '9')
+		end = '9';
+	else if (range.end >= 'A' && range.end <= 'Z')
+		end = 'Z';
+	else if (range.end >= 'a' && range.end <= 'z')
+		end = 'z';
+	else
+		end = '}';
+
+	fprintf(out, "[%c-%c]", start, end);
+}
+
+int is_special(const char ch) {
+	return ch == '\\'
+		|| ch == '['
+		|| ch == '{'
+		|| ch == ')'
+		|| ch == '('
+		|| ch == '+'
+		|| ch == '*'
+		|| ch == '?'
+		|| ch == '.';
+}
+
+double position_entropy(const Range* range, const size_t line_count) {
+	double entropy = 0.0;
+	for (int ch = 0; ch < 256; ++ch) {
+		if (range->count[ch] != 0) {
+			const double p = (double)range->count[ch] / line_count;
+			entropy -= p * log2(p);
+		}
+	}
+	return entropy + 0.0;
+}
+
+double position_agreement(const Range* range, const size_t line_count) {
+	double q = 0.0;
+	for (int ch = 0; ch < 256; ++ch) {
+		const double p = (double)range->count[ch] / line_count;
+		q += p * p;
+	}
+	return q;
+}
+
+void reset_ranges(Range* ranges, const size_t width) {
+	memset(ranges, 0, width * sizeof(*ranges));
+	for (size_t i = 0; i < width; ++i) {
+		ranges[i].start = 127;
+		ranges[i].end = -128;
+		ranges[i].and_mask = 0xff;
+	}
+}
+
+int add_line(Profile* profile, const char* line, const size_t length, const char* previous, const size_t previous_length) {
+	Range* ranges = profile->ranges;
+	const size_t key_size = profile->key_size;
+	const size_t positions = length < profile->width ? length : profile->width;
+
+	// keep the positions of the shortest line, but still count the ones past it
+	int changed = length < key_size;
+	for (size_t i = 0; i < positions; ++i) {
+		changed |= i < key_size && (line[i] < ranges[i].start || line[i] > ranges[i].end
+			|| (ranges[i].or_mask | line[i]) != ranges[i].or_mask
+			|| (ranges[i].and_mask & line[i]) != ranges[i].and_mask);
+		ranges[i].start = line[i] < ranges[i].start ? line[i] : ranges[i].start;
+		ranges[i].end = line[i] > ranges[i].end ? line[i] : ranges[i].end;
+		ranges[i].or_mask |= line[i];
+		ranges[i].and_mask &= line[i];
+		ranges[i].count[(unsigned char)line[i]]++;
+		ranges[i].changes += i < previous_length && line[i] != previous[i];
+	}
+	profile->key_size = profile->line_count == 0 || positions < key_size ? positions : key_size;
+	++profile->line_count;
+	return changed;
+}
+
+size_t count_lengths(const Profile* profile) {
+	size_t num_lengths = 0;
+	for (size_t length = 0; length <= profile->max_length; ++length) {
+		num_lengths += profile->length_count[length] != 0;
+	}
+	return num_lengths;
+}
+
+/*
+* A profile may also be written to a file instead of printed, so keys on many
+* hosts are profiled where they are, and the profiles are merged later. Merging
+* keeps the positions of the shortest line, takes the minimum, the maximum, the
+* OR, and the AND of every position, and adds the histograms, so it gives the
+* same profile as a single pass over all the keys, in any order. Only the
+* changes between the last line of a profile and the first line of the next
+* one are lost. The fields of the file are stored in the machine's byte order:
+*
+*       "sepeprf2", key size, width, line count, maximum line length,
+*       minimum, maximum, OR, and AND of every position (one byte each),
+*       256 counts per position, the changes of every position, and the count
+*       of every line length
+*
+* The width is the number of positions with histograms, which may be larger
+* than the key size, since positions past the shortest line are still counted
+* for the lines that have them.
+*/
+static const char PROFILE_MAGIC[8] = {'s', 'e', 'p', 'e', 'p', 'r', 'f', '2'};
+
+int serialize_profile(const Profile* profile, FILE* file) {
+	const uint64_t header[4] = {profile->key_size, profile->width, profile->line_count, profile->max_length};
+	int ok = fwrite(PROFILE_MAGIC, sizeof(PROFILE_MAGIC), 1, file) == 1
+		&& fwrite(header, sizeof(header), 1, file) == 1;
+	for (size_t i = 0; i < profile->width && ok; ++i) {
+		const char bytes[4] = {profile->ranges[i].start, profile->ranges[i].end,
+			(char)profile->ranges[i].or_mask, (char)profile->ranges[i].and_mask};
+		ok = fwrite(bytes, sizeof(bytes), 1, file) == 1;
+	}
+	for (size_t i = 0; i < profile->width && ok; ++i) {
+		for (int ch = 0; ch < 256 && ok; ++ch) {
+			const uint64_t count = profile->ranges[i].count[ch];
+			ok = fwrite(&count, sizeof(count), 1, file) == 1;
+		}
+	}
+	for (size_t i = 0; i < profile->width && ok; ++i) {
+		const uint64_t changes = profile->ranges[i].changes;
+		ok = fwrite(&changes, sizeof(changes), 1, file) == 1;
+	}
+	for (size_t length = 0; length <= profile->max_length && ok; ++length) {
+		const uint64_t count = profile->length_count[length];
+		ok = fwrite(&count, sizeof(count), 1, file) == 1;
+	}
+	return !ok;
+}
+
+int write_profile(const Profile* profile, const char* path) {
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		fprintf(stderr, "ERROR: could not open %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	const int status = serialize_profile(profile, file);
+	if (fclose(file) != 0 || status != 0) {
+		fprintf(stderr, "ERROR: could not write %s\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+/*
+* The header sizes of a file that was not written by keybuilder cannot be
+* trusted: every position takes 4 bytes, 256 counts and its changes, and every
+* length one count, so they must all fit in the rest of the file. Files that
+* are not regular, like pipes, have no size, and get a generous bound instead.
+*/
+#define POSITION_BYTES (4 + 257 * sizeof(uint64_t))
+#define MAX_STREAMED_PROFILE ((uint64_t)1 << 32)
+
+static int header_fits(const uint64_t header[4], FILE* file) {
+	struct stat file_stat;
+	uint64_t available = MAX_STREAMED_PROFILE;
+	if (fstat(fileno(file), &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+		const uint64_t header_bytes = sizeof(PROFILE_MAGIC) + 4 * sizeof(uint64_t);
+		available = (uint64_t)file_stat.st_size > header_bytes ? file_stat.st_size - header_bytes : 0;
+	}
+	return header[1] <= available / POSITION_BYTES && header[3] < available / sizeof(uint64_t)
+		&& header[1] * POSITION_BYTES + (header[3] + 1) * sizeof(uint64_t) <= available;
+}
+
+int read_profile(Profile* profile, const char* path) {
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		fprintf(stderr, "ERROR: could not open %s: %s\n", path, strerror(errno));
+		return 1;
+	}
+	char magic[sizeof(PROFILE_MAGIC)];
+	uint64_t header[4];
+	int ok = fread(magic, sizeof(magic), 1, file) == 1
+		&& memcmp(magic, PROFILE_MAGIC, sizeof(magic)) == 0
+		&& fread(header, sizeof(header), 1, file) == 1
+		&& header[0] <= header[1] && header[1] <= header[3] && header[2] > 0
+		&& header_fits(header, file);
+	if (ok) {
+		profile->key_size = header[0];
+		profile->width = header[1];
+		profile->line_count = header[2];
+		profile->max_length = header[3];
+		profile->ranges = calloc(profile->width + 1, sizeof(*profile->ranges));
+		profile->length_count = calloc(profile->max_length + 1, sizeof(*profile->length_count));
+		if (profile->ranges == NULL || profile->length_count == NULL) {
+			fprintf(stderr, "ERROR: not enough memory to read %s\n", path);
+			profile->width = 0;
+			profile->max_length = 0;
+			fclose(file);
+			return 1;
+		}
+	}
+	for (size_t i = 0; i < profile->width && ok; ++i) {
+		char bytes[4];
+		ok = fread(bytes, sizeof(bytes), 1, file) == 1;
+		profile->ranges[i].start = bytes[0];
+		profile->ranges[i].end = bytes[1];
+		profile->ranges[i].or_mask = bytes[2];
+		profile->ranges[i].and_mask = bytes[3];
+	}
+	for (size_t i = 0; i < profile->width && ok; ++i) {
+		for (int ch = 0; ch < 256 && ok; ++ch) {
+			uint64_t count;
+			ok = fread(&count, sizeof(count), 1, file) == 1;
+			profile->ranges[i].count[ch] = count;
+		}
+	}
+	for (size_t i = 0; i < profile->width && ok; ++i) {
+		uint64_t changes;
+		ok = fread(&changes, sizeof(changes), 1, file) == 1;
+		profile->ranges[i].changes = changes;
+	}
+	for (size_t length = 0; length <= profile->max_length && ok; ++length) {
+		uint64_t count;
+		ok = fread(&count, sizeof(count), 1, file) == 1;
+		profile->length_count[length] = count;
+	}
+	fclose(file);
+	if (!ok) {
+		fprintf(stderr, "ERROR: %s is not a keybuilder profile\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+void merge_profile(Profile* merged, const Profile* other) {
+	if (merged->line_count == 0) {
+		merged->key_size = other->key_size;
+		merged->width = other->width;
+		merged->ranges = calloc(other->width + 1, sizeof(*merged->ranges));
+		memcpy(merged->ranges, other->ranges, other->width * sizeof(*merged->ranges));
+	} else {
+		merged->key_size = merged->key_size < other->key_size ? merged->key_size : other->key_size;
+		merged->width = merged->width < other->width ? merged->width : other->width;
+		for (size_t i = 0; i < merged->width; ++i) {
+			Range* range = &merged->ranges[i];
+			const Range* other_range = &other->ranges[i];
+			range->start = other_range->start < range->start ? other_range->start : range->start;
+			range->end = other_range->end > range->end ? other_range->end : range->end;
+			range->or_mask |= other_range->or_mask;
+			range->and_mask &= other_range->and_mask;
+			for (int ch = 0; ch < 256; ++ch) {
+				range->count[ch] += other_range->count[ch];
+			}
+			range->changes += other_range->changes;
+		}
+		// positions past the narrowest profile are no longer profiled
+		memset(merged->ranges + merged->width, 0, sizeof(*merged->ranges));
+	}
+	for (size_t length = 0; length <= other->max_length; ++length) {
+		if (other->length_count[length] != 0) {
+			count_length(&merged->length_count, &merged->max_length, length, other->length_count[length]);
+		}
+	}
+	merged->line_count += other->line_count;
+}
+
+/*
+* Counters and timestamps are mostly assigned in order, so their last digits
+* change on every key while their first ones barely move. The velocity of a
+* position is the fraction of consecutive lines that differ on it. Lines in a
+* random order differ on position i with probability 1 - q_i, where q_i is the
+* chance two lines agree on it, so a position much slower than that means the
+* lines are sequential, and keysynth is told to put the fastest positions in
+* the lowest bits of the hash, which pick the bucket.
+*/
+#define SEQUENTIAL_MIN_LINES 64
+#define SEQUENTIAL_MAX_RATIO 0.5
+
+double position_velocity(const Range* range, const size_t line_count) {
+	return line_count > 1 ? (double)range->changes / (line_count - 1) : 0.0;
+}
+
+static int is_sequential(const Profile* profile) {
+	if (profile->line_count < SEQUENTIAL_MIN_LINES) {
+		return 0;
+	}
+	for (size_t i = 0; i < profile->key_size; ++i) {
+		const Range* range = &profile->ranges[i];
+		const double random_velocity = 1.0 - position_agreement(range, profile->line_count);
+		if (range->start != range->end && position_velocity(range, profile->line_count) < SEQUENTIAL_MAX_RATIO * random_velocity) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void print_profile(FILE* out, const Profile* profile) {
+	const Range* ranges = profile->ranges;
+	const size_t key_size = profile->key_size;
+
+	// finally, group consecutive identical ranges together. For example,
+	// `[0-9][0-9][0-9]` will turn into `[0-9]{3}`
+	size_t i = 0;
+	while (i < key_size) {
+		const Range range = ranges[i++];
+		if (range.start == range.end) {
+			if (is_special(range.start)) {
+				fputc('\\', out);
+			}
+			fputc(range.start, out);
+		} else {
+			int repetitions = 1;
+			while (i < key_size && range_class(range) == range_class(ranges[i])) {
+				++i;
+				++repetitions;
+			}
+
+			print_class(out, range);
+			if (repetitions > 1) {
+				fprintf(out, "{%d}", repetitions);
+			}
+		}
+	}
+	fputc('\n', out);
+
+	// the classes above are wider than the characters actually seen, so we
+	// also print the bits observed in every position. A bit that is set in
+	// the OR of all lines but not in their AND is a bit that varies
+	fprintf(out, "--or-mask ");
+	for (i = 0; i < key_size; ++i) {
+		fprintf(out, "%02x", ranges[i].or_mask);
+	}
+	fprintf(out, " --and-mask ");
+	for (i = 0; i < key_size; ++i) {
+		fprintf(out, "%02x", ranges[i].and_mask);
+	}
+
+	// and the Shannon entropy of every position, in bits, so keysynth can
+	// tell which positions tell the keys apart the most
+	fprintf(out, " --entropy ");
+	for (i = 0; i < key_size; ++i) {
+		fprintf(out, i ? ",%.2f" : "%.2f", position_entropy(&ranges[i], profile->line_count));
+	}
+
+	// keys that do not conform to a layout that ignores outliers must be
+	// checked before they are hashed
+	if (profile->guarded) {
+		fprintf(out, " --guarded");
+	}
+
+	// positions determined by the others, which keysynth does not load
+	int first_redundant = 1;
+	for (i = 0; profile->redundant && i < key_size; ++i) {
+		if (profile->redundant[i]) {
+			fprintf(out, first_redundant ? " --redundant %zu" : ",%zu", i);
+			first_redundant = 0;
+		}
+	}
+
+	if (is_sequential(profile)) {
+		fprintf(out, " --velocity ");
+		for (i = 0; i < key_size; ++i) {
+			fprintf(out, i ? ",%.2f" : "%.2f", position_velocity(&ranges[i], profile->line_count));
+		}
+	}
+	fputc('\n', out);
+}
@@ -0,0 +1,59 @@
+/*
+* The profile of a set of keys, shared by the keybuilder program and by the
+* embeddable API in keybuilder.h. See profile.c.
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct Range {
+	char start;
+	char end;
+	unsigned char or_mask;
+	unsigned char and_mask;
+	unsigned long count[256];
+	unsigned long changes;
+} Range;
+
+typedef struct Profile {
+	size_t key_size;
+	size_t width;
+	size_t line_count;
+	Range* ranges;
+	size_t max_length;
+	unsigned long* length_count;
+	int guarded;
+	unsigned char* redundant;
+} Profile;
+
+void count_length(unsigned long** length_count, size_t* max_length, const size_t length, const unsigned long count);
+int range_class(const Range range);
+void print_class(FILE* out, const Range range);
+int is_special(const char ch);
+
+double position_entropy(const Range* range, const size_t line_count);
+double position_agreement(const Range* range, const size_t line_count);
+double position_velocity(const Range* range, const size_t line_count);
+
+/* empties the ranges, so the first line added sets them */
+void reset_ranges(Range* ranges, const size_t width);
+
+/*
+* adds a line to the ranges of the profile, and returns whether it changed
+* them. The line length must be counted with count_length separately
+*/
+int add_line(Profile* profile, const char* line, const size_t length, const char* previous, const size_t previous_length);
+size_t count_lengths(const Profile* profile);
+
+int serialize_profile(const Profile* profile, FILE* file);
+int write_profile(const Profile* profile, const char* path);
+int read_profile(Profile* profile, const char* path);
+void merge_profile(Profile* merged, const Profile* other);
+
+/* prints the regex, and the options for keysynth in a second line */
+void print_profile(FILE* out, const Profile* profile);
+
+#endif
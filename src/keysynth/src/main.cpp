@@ -1,9 +1,13 @@
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <queue>
 #include <utility>
 #include <algorithm>
+#include <cmath>
+#include <fstream>
 
 // Constant to hold a helper function used within the synthetized functions
 static const std::string load_u64_le = "inline static uint64_t load_u64_le(const char* b) {\n\
@@ -37,7 +41,7 @@ struct Range{
     char end; ///< The end character of the range.
     int offset; ///< The offset of the range.
     size_t repetition; ///< The repetition count of the range.
-    char mask; ///< The mask associated with the range. Only useful for PEXT.
+    unsigned char mask; ///< The mask associated with the range. Only useful for PEXT.
 
     Range(char _start, char _end, int _offset, size_t _repetition) :
         start(_start),
@@ -152,10 +156,10 @@ static std::string recursivelyCalculateMask(const std::vector<Range>& ranges, si
 }
 
 // Returns a hashable variable for the pext hash function
-static std::string hashablePext(int hashableID, size_t offset){
+static std::string hashablePext(int hashableID, size_t offset, const std::string& keyPtr = "key.c_str()"){
     return "\t\tconst std::size_t hashable" +
                 std::to_string(hashableID) +
-                " = _pext_u64(load_u64_le(key.c_str()+" +
+                " = _pext_u64(load_u64_le(" + keyPtr + "+" +
                 std::to_string(offset) +
                 "), mask" +
                 std::to_string(hashableID) +
@@ -163,19 +167,19 @@ static std::string hashablePext(int hashableID, size_t offset){
 }
 
 // Returns a hashable variable for the naive hash function
-static std::string hashableNaive(int hashableID, size_t offset){
+static std::string hashableNaive(int hashableID, size_t offset, const std::string& keyPtr = "key.c_str()"){
     return "\t\tconst std::size_t hashable" +
                 std::to_string(hashableID) +
-                " = load_u64_le(key.c_str()+" +
+                " = load_u64_le(" + keyPtr + "+" +
                 std::to_string(offset) +
                 ");\n";
 }
 
 // Returns a hashable variable for the vectorized/SIMD naive hash function
-static std::string hashableNaiveSIMD(int hashableID, size_t offset){
+static std::string hashableNaiveSIMD(int hashableID, size_t offset, const std::string& keyPtr = "key.c_str()"){
     return "\t\tconst __m128i hashable" +
                 std::to_string(hashableID) +
-                " = _mm_lddqu_si128((const __m128i *)(key.c_str()+" +
+                " = _mm_lddqu_si128((const __m128i *)(" + keyPtr + "+" +
                 std::to_string(offset) +
                 "));\n";
 }
@@ -206,7 +210,7 @@ static std::vector<size_t> calculateOffsets(std::vector<Range>& ranges, int regS
                     ++rangesID;
                 }
             }
-            if (ranges[rangesID].offset > currOffset ){
+            if (rangesID < ranges.size() && ranges[rangesID].offset > currOffset ){
                 currOffset = ranges[rangesID].offset;
             }
         }
@@ -214,12 +218,66 @@ static std::vector<size_t> calculateOffsets(std::vector<Range>& ranges, int regS
     return offsets;
 }
 
+/**
+ * @brief Calculate the mask of every byte of the key, for padded keys.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size.
+ * @param regSize The size of the register. The masks are followed by this many zeroes, for the last load.
+ * @return std::vector<unsigned char> The mask of every byte, zero for constant bytes and for the padding.
+ */
+static std::vector<unsigned char> calculateByteMasks(const std::vector<Range>& ranges, size_t offset, size_t regSize){
+    std::vector<unsigned char> byteMasks(offset + regSize, 0);
+    for(const auto& range : ranges){
+        for(size_t i = 0; i < range.repetition; i++){
+            byteMasks[range.offset + i] = range.mask;
+        }
+    }
+    return byteMasks;
+}
+
+/**
+ * @brief Calculate the offsets of a padded key.
+ *
+ * Padded keys are loaded with a fixed stride from their first variable byte, and a run of constant bytes as long as a
+ * register restarts the stride at the next variable byte. Loads never move back into the key, so they never overlap,
+ * and the last one may read past the end of the key.
+ *
+ * @param byteMasks The mask of every byte, as calculated by calculateByteMasks.
+ * @param regSize The size of the register.
+ * @return std::vector<size_t> The vector of offsets.
+ */
+static std::vector<size_t> calculatePaddedOffsets(const std::vector<unsigned char>& byteMasks, size_t regSize){
+    std::vector<size_t> offsets;
+    const size_t keySize = byteMasks.size() - regSize;
+    size_t off = 0;
+    while(off < keySize){
+        if(byteMasks[off] == 0){
+            off++;
+            continue;
+        }
+        offsets.push_back(off);
+        off += regSize;
+    }
+    return offsets;
+}
+
+// Mask of the bytes of a load at `off` that are inside a key of `keySize` bytes, as 16 hexadecimal digits
+static std::string tailMask(size_t off, size_t keySize){
+    const size_t inside = keySize - off;
+    char tail[17];
+    snprintf(tail, sizeof(tail), "%016lx", inside >= 8 ? ~0ul : (1ul << (8 * inside)) - 1);
+    return tail;
+}
+
 /**
  * @brief Calculate the ranges for a given regular expression string.
  *
  * This function calculates the ranges for a given regular expression string. It does this by iterating over the characters in the
  * string and creating a Range object for each range found in the string. The offset is incremented for each character in the string
- * that is not part of a range. If no ranges are found in the string, the function prints a default function and exits.
+ * that is not part of a range. A class without a repetition count, such as the [a-z] of keybuilder's [a-z][0-9][a-z], covers
+ * the position it appears at. If no ranges are found in the string, the key is constant and the vector is empty: the caller
+ * decides how to hash it, since a constant field of a multi-field key is skipped instead of replacing the whole hash.
  *
  * @param regex The regular expression string.
  * @param charEntropy The vector of character entropy values.
@@ -238,8 +296,8 @@ calculateRanges(std::string& regex){
                 offset += repetition;
                 i = closeBracketPos;
             } else {
-                offset++;
                 ranges.push_back(Range(regex[i+1],regex[i+3],offset,1));
+                offset++;
                 i += 4;
             }
         } else if(regex[i] == '\\') {
@@ -250,17 +308,103 @@ calculateRanges(std::string& regex){
         }
     }
 
-    if(ranges.size() == 0){
-        std::cout << "// No regex ranges in the key. Using default Function. \n\
-            struct synthesizedHashFunc{\n\
-                std::size_t operator()(const std::string& key) const {\n\
-                    \treturn std::hash<std::string>{}(key);\n\
-                }\n\
-            }\n";
-            exit(0);
+    return std::make_pair(ranges,offset);
+}
+
+/**
+ * @brief Calculate the ranges of a fixed size binary key.
+ *
+ * Binary keys have no character classes, so instead of a regex, keybuilder prints the bits that vary across the
+ * sampled records, one byte at a time, as hexadecimal digits. Every byte with at least one varying bit becomes a Range
+ * whose mask is exactly those bits.
+ *
+ * @param binaryMask The hexadecimal mask printed by `keybuilder --binary`, two digits per byte of the key.
+ * @return std::pair<std::vector<Range>,size_t> A pair containing the vector of Range objects and the key size.
+ */
+static std::pair<std::vector<Range>,size_t>
+calculateBinaryRanges(const std::string& binaryMask){
+    std::vector<Range> ranges;
+    const size_t keySize = binaryMask.size() / 2;
+    for(size_t i = 0; i < keySize; i++){
+        const unsigned char mask = std::stoul(binaryMask.substr(2 * i, 2), nullptr, 16);
+        if(mask == 0){
+            continue;
+        }
+        Range range(0, 0, i, 1);
+        range.mask = mask;
+        ranges.push_back(range);
     }
 
-    return std::make_pair(ranges,offset);
+    return std::make_pair(ranges,keySize);
+}
+
+/**
+ * @brief Calculate the ranges of a text key, from the bits observed by keybuilder when they are available.
+ *
+ * The regex classes are wider than the characters actually seen. For example, a position holding only hexadecimal
+ * digits becomes [0-z], whose mask is 0x7f. keybuilder also prints the OR and the AND of every position across all
+ * keys, and the bits set in the OR but not in the AND are exactly the bits that vary, so they become the masks instead.
+ *
+ * @param regex The regular expression string.
+ * @param orMask The OR of every position, as printed by keybuilder. Empty if not available.
+ * @param andMask The AND of every position, as printed by keybuilder. Empty if not available.
+ * @return std::pair<std::vector<Range>,size_t> A pair containing the vector of Range objects and the final offset.
+ */
+static std::pair<std::vector<Range>,size_t>
+calculateKeyRanges(std::string& regex, const std::string& orMask, const std::string& andMask){
+    std::pair<std::vector<Range>,size_t> res = calculateRanges(regex);
+    if(orMask.empty()){
+        return res;
+    }
+    if(orMask.size() != 2 * res.second){
+        fprintf(stderr, "WARNING: observed masks do not match the regex size, ignoring them.\n");
+        return res;
+    }
+
+    std::string varyingBits;
+    for(size_t i = 0; i < orMask.size(); i += 2){
+        const size_t ors = std::stoul(orMask.substr(i, 2), nullptr, 16);
+        const size_t ands = std::stoul(andMask.substr(i, 2), nullptr, 16);
+        varyingBits += intToHex(ors & ~ands & 0xff);
+    }
+    return calculateBinaryRanges(varyingBits);
+}
+
+/**
+ * @brief Remove the positions that are determined by the other ones from the ranges.
+ *
+ * keybuilder --redundant prints the positions, such as check digits, whose value is a function of the remaining ones
+ * across the sampled keys. They do not tell any keys apart, so the hash functions do not need to load them. Ranges that
+ * contain such positions are split around them.
+ *
+ * @param ranges The ranges of the key.
+ * @param redundant The redundant positions of the key.
+ * @return std::vector<Range> The ranges without the redundant positions.
+ */
+static std::vector<Range> dropRedundantPositions(const std::vector<Range>& ranges, const std::vector<size_t>& redundant){
+    std::vector<Range> kept;
+    for(const Range& range : ranges){
+        Range run = range;
+        run.repetition = 0;
+        for(size_t i = 0; i < range.repetition; i++){
+            const size_t pos = range.offset + i;
+            if(std::find(redundant.begin(), redundant.end(), pos) == redundant.end()){
+                if(run.repetition == 0){
+                    run.offset = pos;
+                }
+                run.repetition++;
+                continue;
+            }
+            if(run.repetition > 0){
+                kept.push_back(run);
+                run.repetition = 0;
+            }
+        }
+        if(run.repetition > 0){
+            kept.push_back(run);
+        }
+    }
+    return kept;
 }
 
 /**
@@ -318,17 +462,16 @@ static std::string cascadeAesVars(std::queue<std::string>& queue){
  *
  * This function unrolls masks and calculates shifts. It does this by iterating over the mask string in chunks of 16 characters.
  * Each chunk is converted to little-endian, shifted until there are no zeroes on the right, and then adjusted to avoid out of bounds memory access.
- * The number of zeroes in the mask is counted and stored in a vector. The mask code string is also constructed for each mask.
+ * The number of zeroes in the mask is counted and stored in a vector, alongside the hexadecimal string of each mask.
  *
  * @param mask The mask string.
  * @param lastMaskShift The shift for the last mask.
- * @return std::pair<std::vector<int>, std::string> A pair containing the vector of shifts and the resulting mask code strings.
+ * @return std::pair<std::vector<int>, std::vector<std::string>> A pair containing the vector of shifts and the vector of masks.
  */
-static std::pair<std::vector<int>, std::string>
+static std::pair<std::vector<int>, std::vector<std::string>>
 unrollMasks_calculateShift(std::string& mask, size_t lastMaskShift){
-    int maskID = 0;
     std::vector<int> shifts;
-    std::string masksStr;
+    std::vector<std::string> masks;
     for(size_t i = 0; i < mask.size(); i+=16){
         std::string currMask = mask.substr(i,16);
 
@@ -361,17 +504,11 @@ unrollMasks_calculateShift(std::string& mask, size_t lastMaskShift){
             currMask = currMask.substr(lastMaskShift*2,currMask.size());
         }
 
-        long maskInt = std::stold("0x" + currMask);
+        size_t maskInt = std::stoull(currMask, nullptr, 16);
         shifts.push_back(countZeros(maskInt));
-
-        masksStr += "\t\tconstexpr std::size_t mask" +
-                    std::to_string(maskID) +
-                    " = 0x" +
-                    currMask +
-                    ";\n";
-        maskID++;
+        masks.push_back(currMask);
     }
-    return std::make_pair(shifts, masksStr);
+    return std::make_pair(shifts, masks);
 }
 
 /**
@@ -481,7 +618,7 @@ std::string skipTable_synthetizePextHashFunc(std::vector<Range>& ranges, size_t
             currMask = currMask.substr(outOfBoundsBytes*2,currMask.size());
         }
 
-        long maskInt = std::stold("0x" + currMask);
+        size_t maskInt = std::stoull(currMask, nullptr, 16);
         shifts.push_back(countZeros(maskInt));
 
         masksStr += "\t\tconstexpr std::size_t mask" +
@@ -529,16 +666,29 @@ std::string skipTable_synthetizePextHashFunc(std::vector<Range>& ranges, size_t
 }
 
 /**
- * @brief Synthesize a PEXT hash function.
+ * @struct PextLoad
+ * @brief A single load of the synthesized PEXT hash function.
  *
- * This function synthesizes a PEXT hash function. It does this by taking a vector of Range objects and an offset as input.
- * The general idea of the implementation is to compress the input key into relevant bytes and only hashing them.
+ * Each load reads 8 bytes of the key at `offset`, compresses them with `mask` and left shifts the result by `shift`
+ * before XORing it with the other loads.
+ */
+struct PextLoad{
+    size_t offset; ///< Offset of the 8 bytes load in the key.
+    std::string mask; ///< Little-endian PEXT mask of the load, as 16 hexadecimal digits.
+    int shift; ///< Left shift applied to the compressed load.
+};
+
+/**
+ * @brief Calculate the loads of a PEXT hash function.
+ *
+ * This function calculates the offset, mask, and shift of every load of the 'NO SKIP TABLE' PEXT hash function.
+ * Every other load is shifted left as much as possible for better collision.
  *
  * @param ranges The vector of Range objects.
  * @param offset Total key size to use as a base in offset calculation
- * @return std::string The synthesized PEXT hash function as a string.
+ * @return std::vector<PextLoad> The loads of the PEXT hash function.
  */
-std::string synthetizePextHashFunc(std::vector<Range>& ranges, size_t offset){
+static std::vector<PextLoad> calculatePextLayout(std::vector<Range>& ranges, size_t offset){
 
     // Calculate offsets
     std::vector<size_t> offsets = calculateOffsets(ranges);
@@ -550,8 +700,6 @@ std::string synthetizePextHashFunc(std::vector<Range>& ranges, size_t offset){
         offsets[offsets.size()-1] = offset - 8;
     }
 
-    std::string synthesizedHashFunc = "struct synthesizedPextHash {\n\tstd::size_t operator()(const std::string& key) const {\n";
-
     // Calculate all concatenated masks based on ranges
     std::string _mask = recursivelyCalculateMask(ranges, 0, 0);
 
@@ -574,14 +722,77 @@ std::string synthetizePextHashFunc(std::vector<Range>& ranges, size_t offset){
     }
 
     // Unroll Masks and calculate shifts
-    std::pair<std::vector<int>, std::string> res_thank_you_cpp_compiler = unrollMasks_calculateShift(mask, lastMaskShift);
+    std::pair<std::vector<int>, std::vector<std::string>> res_thank_you_cpp_compiler = unrollMasks_calculateShift(mask, lastMaskShift);
     std::vector<int> shifts = res_thank_you_cpp_compiler.first;
-    synthesizedHashFunc += res_thank_you_cpp_compiler.second;
+    std::vector<std::string> masks = res_thank_you_cpp_compiler.second;
+
+    std::vector<PextLoad> layout;
+    for(size_t i = 0; i < offsets.size() && i < masks.size(); i++){
+        layout.push_back({offsets[i], masks[i], i % 2 == 0 ? 0 : shifts[i]});
+    }
+    return layout;
+}
+
+/**
+ * @brief Calculate the loads of a PEXT hash function of padded keys.
+ *
+ * Loads follow calculatePaddedOffsets, and the bytes past the end of the key are already outside the masks, so no
+ * load is moved back or overlaps another one.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @return std::vector<PextLoad> The loads of the PEXT hash function.
+ */
+static std::vector<PextLoad> calculatePaddedPextLayout(std::vector<Range>& ranges, size_t offset){
+    std::vector<unsigned char> byteMasks = calculateByteMasks(ranges, offset, 8);
+
+    std::vector<PextLoad> layout;
+    for(const auto& off : calculatePaddedOffsets(byteMasks, 8)){
+        size_t maskInt = 0;
+        for(size_t byte = 0; byte < 8; byte++){
+            maskInt |= (size_t)byteMasks[off + byte] << (8 * byte);
+        }
+        char mask[17];
+        snprintf(mask, sizeof(mask), "%016lx", maskInt);
+        layout.push_back({off, mask, layout.size() % 2 == 0 ? 0 : countZeros(maskInt)});
+    }
+    return layout;
+}
+
+/**
+ * @brief Synthesize a PEXT hash function.
+ *
+ * This function synthesizes a PEXT hash function. It does this by taking a vector of Range objects and an offset as input.
+ * The general idea of the implementation is to compress the input key into relevant bytes and only hashing them.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param padding Number of readable bytes after the end of the key. If non-zero, loads have a fixed stride, they are
+ *                never moved back into the key, and the function takes a pointer to the key.
+ * @return std::string The synthesized PEXT hash function as a string.
+ */
+std::string synthetizePextHashFunc(std::vector<Range>& ranges, size_t offset, size_t padding = 0){
+
+    std::vector<PextLoad> layout = padding ? calculatePaddedPextLayout(ranges, offset) : calculatePextLayout(ranges, offset);
+    const std::string keyPtr = padding ? "key" : "key.c_str()";
+
+    std::string synthesizedHashFunc = "struct synthesizedPextHash {\n";
+    synthesizedHashFunc += padding ? "\t// Reads up to 7 bytes past the end of the key, which must be followed by at least " + std::to_string(padding) + " readable bytes\n"
+                                     "\tstd::size_t operator()(const char* key) const {\n"
+                                   : "\tstd::size_t operator()(const std::string& key) const {\n";
+
+    for(size_t i = 0; i < layout.size(); i++){
+        synthesizedHashFunc += "\t\tconstexpr std::size_t mask" +
+                    std::to_string(i) +
+                    " = 0x" +
+                    layout[i].mask +
+                    ";\n";
+    }
 
     // Create hashables
     int hashableID = 0;
-    for(const auto& off : offsets){
-        synthesizedHashFunc += hashablePext(hashableID++, off);
+    for(const auto& load : layout){
+        synthesizedHashFunc += hashablePext(hashableID++, load.offset, keyPtr);
     }
 
     // Create hashable variables and left shift them as much as possible for better collision
@@ -589,7 +800,7 @@ std::string synthetizePextHashFunc(std::vector<Range>& ranges, size_t offset){
         if (i % 2 == 0) {
             synthesizedHashFunc += "\t\tsize_t shift" + std::to_string(i) + " = " + "hashable" + std::to_string(i) + ";\n";
         } else {
-            synthesizedHashFunc += "\t\tsize_t shift" + std::to_string(i) + " = " + "hashable" + std::to_string(i) + " << " + std::to_string(shifts[i]) + ";\n";
+            synthesizedHashFunc += "\t\tsize_t shift" + std::to_string(i) + " = " + "hashable" + std::to_string(i) + " << " + std::to_string(layout[i].shift) + ";\n";
         }
     }
 
@@ -609,153 +820,1867 @@ std::string synthetizePextHashFunc(std::vector<Range>& ranges, size_t offset){
 }
 
 /**
- * @brief Synthesize an Offset XOR hash function.
+ * @brief Synthesize the layout table of the PEXT hash function.
  *
- * This function synthesizes an Offset XOR hash function. It does this by taking a vector of Range objects and an offset as input.
- * This is a naive implementation that just XORs bytes at the given offsets.
+ * Instead of C++ code, this function outputs the loads of the 'NO SKIP TABLE' PEXT hash function as a plain text table,
+ * which keyuser's RuntimePext and RuntimeOffXor hashes read at startup. The first line holds the key size and the number
+ * of loads, and every following line holds the offset, the hexadecimal mask, and the shift of one load:
+ *
+ *      sepe-layout 15 2
+ *      0 000f0f0f000f0f0f 0
+ *      7 0f0f0f000f0f0f00 40
  *
  * @param ranges The vector of Range objects.
  * @param offset Total key size to use as a base in offset calculation
- * @return std::string The synthesized Offset XOR hash function as a string.
+ * @return std::string The layout table as a string.
  */
-std::string synthetizeOffXorHashFunc(std::vector<Range>& ranges, size_t offset){
+std::string synthetizePextLayout(std::vector<Range>& ranges, size_t offset){
 
-    // Calculate offsets
-    std::vector<size_t> offsets = calculateOffsets(ranges);
+    std::vector<PextLoad> layout = calculatePextLayout(ranges, offset);
 
-    // Avoid out of bounds memory access on the last mask/offset
-    if (offsets[offsets.size()-1] + 8 >= offset){
-        offsets[offsets.size()-1] = offset - 8;
+    std::string synthesizedLayout = "sepe-layout " + std::to_string(offset) + " " + std::to_string(layout.size()) + "\n";
+    for(const auto& load : layout){
+        synthesizedLayout += std::to_string(load.offset) + " " + load.mask + " " + std::to_string(load.shift) + "\n";
     }
 
-    std::string synthesizedHashFunc = "struct synthesizedOffXorHash {\n\tstd::size_t operator()(const std::string& key) const {\n";
+    return synthesizedLayout;
+}
 
-    // Create hashables
-    int hashableID = 0;
-    for(const auto& off : offsets){
-        synthesizedHashFunc += hashableNaive(hashableID++, off);
+/**
+ * @brief Synthesize an order-preserving sort key extractor.
+ *
+ * The loads of the PEXT hash function are converted to big-endian, so the first byte of the key goes to the most
+ * significant bits, and their compressed bits are concatenated in key order instead of XORed. Since the dropped bits
+ * are the same in every key, comparing two sort keys gives the same result as comparing the keys themselves, and they
+ * can be sorted with an integer radix sort.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @return std::string The synthesized sort key extractor as a string, or an empty string if it needs more than 128 bits.
+ */
+std::string synthetizeSortKeyFunc(std::vector<Range>& ranges, size_t offset){
+
+    std::vector<PextLoad> layout = calculatePextLayout(ranges, offset);
+
+    std::vector<int> bits;
+    int totalBits = 0;
+    for(const auto& load : layout){
+        bits.push_back(64 - countZeros(std::stoull(load.mask, nullptr, 16)));
+        totalBits += bits.back();
+    }
+    if(totalBits > 128){
+        return "";
     }
+    const std::string type = totalBits > 64 ? "__uint128_t" : "uint64_t";
 
-    // Create queue of "XORable" variables
-    std::queue<std::string> queue;
-    for (int i = 0; i < hashableID; ++i) {
-        queue.push("hashable" + std::to_string(i));
+    std::string synthesizedSortKey = "// Sort key of " + std::to_string(totalBits) + " bits\n";
+    synthesizedSortKey += "struct synthesizedSortKey {\n\t" + type + " operator()(const std::string& key) const {\n";
+
+    for(size_t i = 0; i < layout.size(); i++){
+        char maskStr[17];
+        sprintf(maskStr, "%016lx", __builtin_bswap64(std::stoull(layout[i].mask, nullptr, 16)));
+        synthesizedSortKey += "\t\tconstexpr std::size_t mask" + std::to_string(i) + " = 0x" + maskStr + ";\n";
     }
 
-    // Cascade XOR variables
-    synthesizedHashFunc += cascadeXorVars(queue);
+    // Big-endian loads, so the first bytes of the key are the most significant
+    for(size_t i = 0; i < layout.size(); i++){
+        synthesizedSortKey += "\t\tconst " + type + " sortable" + std::to_string(i) +
+                              " = _pext_u64(__builtin_bswap64(load_u64_le(key.c_str()+" + std::to_string(layout[i].offset) +
+                              ")), mask" + std::to_string(i) + ");\n";
+    }
 
-    synthesizedHashFunc += "\t\treturn " + queue.front() + "; \n";
-    synthesizedHashFunc += "\t}\n};\n";
+    // Concatenate the compressed loads in key order
+    synthesizedSortKey += "\t\treturn ";
+    int remainingBits = totalBits;
+    for(size_t i = 0; i < layout.size(); i++){
+        remainingBits -= bits[i];
+        synthesizedSortKey += (i ? " | " : "") + std::string("(sortable") + std::to_string(i) + " << " + std::to_string(remainingBits) + ")";
+    }
+    synthesizedSortKey += ";\n";
+    synthesizedSortKey += "\t}\n};\n";
 
-    return synthesizedHashFunc;
+    return synthesizedSortKey;
 }
 
 /**
- * @brief Synthesize an Aes Hash Function.
+ * @brief Estimate the entropy of one bit of a position of the key.
  *
- * This function synthesizes an Aes hash function. It does this by taking a vector of Range objects and an offset as input.
- * This is an implementation that keeps reducing the number of available bytes by repeatedly calling Aes instructions
+ * The symbols of the position are assumed to be uniform over its character class, or over the values of its mask if
+ * the range was built from the bits observed by keybuilder. If keybuilder also printed the entropy of every position,
+ * the estimate is scaled by how far the position falls short of that uniform distribution, so that the bits of a
+ * skewed position, such as the first digit of an IPv4 octet, rank below the ones of a uniform position.
+ *
+ * @param range The range of the position.
+ * @param bit The index of the bit in the character, 0 to 7.
+ * @param entropy The entropy of the position, printed by keybuilder. Negative if unknown.
+ * @return double The estimated entropy of the bit, between 0 and 1.
+ */
+static double estimateBitEntropy(const Range& range, int bit, double entropy){
+    if(!((range.mask >> bit) & 1)){
+        return 0.0;
+    }
+    const unsigned first = (unsigned char)range.start;
+    const unsigned last = (unsigned char)range.end;
+    if(last <= first){
+        const int maskBits = __builtin_popcount(range.mask);
+        return entropy < 0.0 ? 1.0 : std::min(1.0, entropy / maskBits);
+    }
+    size_t ones = 0;
+    for(unsigned ch = first; ch <= last; ch++){
+        ones += (ch >> bit) & 1;
+    }
+    const double symbols = last - first + 1;
+    const double p = ones / symbols;
+    if(p <= 0.0 || p >= 1.0){
+        return 0.0;
+    }
+    const double bitEntropy = -(p * std::log2(p) + (1 - p) * std::log2(1 - p));
+    return entropy < 0.0 ? bitEntropy : bitEntropy * std::min(1.0, entropy / std::log2(symbols));
+}
+
+/**
+ * @brief Synthesize a partition function, which splits the keys into 2^k partitions.
+ *
+ * The partition is extracted from a single load. The main PEXT hash function shifts every other load to its most
+ * significant bits, which hash tables index the least, so the partition bits are taken from one of these loads (or
+ * from the only load), and the hash table of each partition still tells its keys apart. Bits that overlapping loads
+ * also feed into the least significant bits of the hash are left out. The remaining bits are ranked by their
+ * estimated entropy, from the --entropy printed by keybuilder if given, so that the partitions are as even as
+ * possible, and the load with the most entropy is chosen. The bits of a character are not independent, so every bit
+ * already taken from a byte halves the rank of its other bits. Ties keep the lowest bit of every byte first, starting
+ * from the last bytes of the load.
  *
  * @param ranges The vector of Range objects.
  * @param offset Total key size to use as a base in offset calculation
- * @return std::string The synthesized Offset XOR SIMD hash function as a string.
+ * @param entropy The entropy of every position, printed by keybuilder. May be empty.
+ * @return std::string The synthesized partition function as a string.
  */
-std::string synthetizeAesHashFunc(std::vector<Range>& ranges, size_t offset) {
-    // Calculate offsets
-    std::vector<size_t> offsets = calculateOffsets(ranges, 16);
+std::string synthetizePartitionFunc(std::vector<Range>& ranges, size_t offset, const std::vector<double>& entropy){
 
-    // Avoid out of bounds memory access on the last mask/offset
-    if (offsets[offsets.size()-1] + 16 >= offset){
-        offsets[offsets.size()-1] = offset - 16;
+    std::vector<PextLoad> layout = calculatePextLayout(ranges, offset);
+
+    // Range of every position of the key
+    std::vector<const Range*> positionRanges(offset + 8, nullptr);
+    for(const auto& range : ranges){
+        for(size_t i = 0; i < range.repetition && range.offset + i < offset; i++){
+            positionRanges[range.offset + i] = &range;
+        }
     }
 
-    std::string synthesizedHashFunc = "struct synthesizeAesHash {\n\tstd::size_t operator()(const std::string& key) const {\n";
+    // Bits of the key in the loads the hash function does not shift, which end up in its least significant bits
+    std::vector<bool> lowBits(8 * (offset + 8), false);
+    for(size_t i = 0; i < layout.size() && layout.size() > 1; i += 2){
+        const size_t mask = std::stoull(layout[i].mask, nullptr, 16);
+        for(int bit = 0; bit < 64; bit++){
+            lowBits[8 * layout[i].offset + bit] = lowBits[8 * layout[i].offset + bit] || ((mask >> bit) & 1);
+        }
+    }
 
-    // Create hashables
-    int hashableID = 0;
-    for(const auto& off : offsets){
-        synthesizedHashFunc += hashableNaiveSIMD(hashableID++, off);
+    struct PartitionBit{
+        double entropy; ///< Estimated entropy of the bit.
+        int byte; ///< Byte of the load the bit belongs to.
+        size_t mask; ///< Mask of the bit in the load.
+    };
+    size_t chosen = 0;
+    double chosenEntropy = -1.0;
+    std::vector<PartitionBit> chosenBits;
+    const size_t firstShifted = layout.size() > 1 ? 1 : 0;
+    for(size_t i = firstShifted; i < layout.size(); i += 2){
+        const size_t mask = std::stoull(layout[i].mask, nullptr, 16);
+        std::vector<PartitionBit> bits;
+        double loadEntropy = 0.0;
+        for(int bit = 0; bit < 8; bit++){
+            for(int byte = 7; byte >= 0; byte--){
+                const size_t position = layout[i].offset + byte;
+                if(!((mask >> (8 * byte + bit)) & 1) || lowBits[8 * position + bit] || !positionRanges[position]){
+                    continue;
+                }
+                const double bitEntropy = estimateBitEntropy(*positionRanges[position], bit,
+                                                             entropy.size() == offset ? entropy[position] : -1.0);
+                bits.push_back({bitEntropy, byte, 1ul << (8 * byte + bit)});
+                loadEntropy += bitEntropy;
+            }
+        }
+        if(loadEntropy > chosenEntropy){
+            chosen = i;
+            chosenEntropy = loadEntropy;
+            chosenBits = bits;
+        }
     }
 
-    // Create queue of "AESable" variables
-    std::queue<std::string> queue;
-    for (int i = 0; i < hashableID; ++i) {
-        queue.push("hashable" + std::to_string(i));
+    // Greedy ranking, every bit taken from a byte halves the rank of the other bits of that byte
+    std::vector<PartitionBit> rankedBits;
+    int takenFromByte[8] = {0};
+    while(!chosenBits.empty()){
+        size_t best = 0;
+        for(size_t j = 1; j < chosenBits.size(); j++){
+            if(chosenBits[j].entropy / (1 << takenFromByte[chosenBits[j].byte]) >
+               chosenBits[best].entropy / (1 << takenFromByte[chosenBits[best].byte])){
+                best = j;
+            }
+        }
+        takenFromByte[chosenBits[best].byte]++;
+        rankedBits.push_back(chosenBits[best]);
+        chosenBits.erase(chosenBits.begin() + best);
     }
 
-    // Cascade XOR variables
-    synthesizedHashFunc += cascadeAesVars(queue);
+    // Masks of the first k chosen bits, for every k
+    std::string masksStr = "\t\t0x0000000000000000,\n";
+    size_t partitionMask = 0;
+    for(const auto& bit : rankedBits){
+        partitionMask |= bit.mask;
+        char maskStr[17];
+        sprintf(maskStr, "%016lx", partitionMask);
+        masksStr += "\t\t0x" + std::string(maskStr) + ",\n";
+    }
+    const int maxBits = rankedBits.size();
 
-    synthesizedHashFunc += "\t\treturn _mm_extract_epi64("+queue.front()+", 0) ^ _mm_extract_epi64("+queue.front()+" , 1); \n";
-    synthesizedHashFunc += "\t}\n};\n";
-    synthesizedHashFunc = "#include <immintrin.h>\n#include <wmmintrin.h>\n" + synthesizedHashFunc;
+    std::string synthesizedPartitionFunc = "template <unsigned k>\n";
+    synthesizedPartitionFunc += "inline std::size_t partition(const std::string& key) {\n";
+    synthesizedPartitionFunc += "\tstatic_assert(k >= 1 && k <= " + std::to_string(maxBits) + ", \"The partition load has only " +
+                                std::to_string(maxBits) + " variable bits\");\n";
+    synthesizedPartitionFunc += "\tconstexpr std::size_t masks[] = {\n" + masksStr + "\t};\n";
+    synthesizedPartitionFunc += "\treturn _pext_u64(load_u64_le(key.c_str()+" + std::to_string(layout[chosen].offset) + "), masks[k]);\n";
+    synthesizedPartitionFunc += "}\n";
 
-    return synthesizedHashFunc;
+    return synthesizedPartitionFunc;
 }
 
 /**
- * @brief Synthesize an Aes Hash Function for keys of size < 16.
+ * @brief Seed of the family hash functions, also used by keyuser's RuntimePextFamily.
  *
- * This function does the same as the synthesizedHashFunc, but deals with the special case of the key's size
- * being smaller of equal to 16
+ * @param hashID The index of the hash function in the family.
+ * @param slot The index of the hashable the seed is mixed with.
+ * @return size_t A splitmix64 constant with its most significant bit set, so it never cancels a compressed load.
+ */
+static size_t familySeed(size_t hashID, size_t slot){
+    size_t z = (hashID * 64 + slot + 1) * 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return (z ^ (z >> 31)) | (1ul << 63);
+}
+
+/**
+ * @brief Maximum number of hash functions of a family, far more than cuckoo tables and Bloom filters use.
+ */
+constexpr size_t FAMILY_MAX_SIZE = 64;
+
+/**
+ * @brief Largest padding accepted by --padded. The loads read at most 15 bytes past a key, so more is never needed.
+ */
+constexpr size_t PADDING_MAX_SIZE = 4096;
+
+/**
+ * @brief Synthesize a family of k independent hash functions over the loads of the PEXT hash function.
+ *
+ * The Pext and OffXor functions XOR the same loads, so keys that collide in one also tend to collide in the other.
+ * Instead, every function of the family XORs each compressed load with its own seeds, and multiplies pairs of them into
+ * 128 bits, folding the high and the low halves (as wyhash does). The keys are loaded only once for all functions, at
+ * the cost of one multiplication per pair of loads per function.
  *
  * @param ranges The vector of Range objects.
- * @param regexSize The full key's size.
- * @return std::string The synthesized Offset XOR SIMD hash function as a string.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param familySize The number of hash functions, k.
+ * @return std::string The synthesized family of hash functions as a string.
  */
-std::string synthetizeAesHashFuncLe16bytes(size_t keySize) {
-    keySize = keySize > 16 ? 16 : keySize;
+std::string synthetizeFamilyHashFunc(std::vector<Range>& ranges, size_t offset, size_t familySize){
 
-    std::string synthesizedHashFunc = "struct synthesizeAesHash {\n\tstd::size_t operator()(const std::string& key) const {\n";
-    synthesizedHashFunc += "\t\t// chosen by a fair roll of the dice\n";
-    synthesizedHashFunc += "\t\tconst __m128i roundkey = _mm_set_epi64x(0xFB6D468E93C391E2 , 0x9c06f0be6f44851b);\n";
+    std::vector<PextLoad> layout = calculatePextLayout(ranges, offset);
 
-    if (keySize == 16) {
-        // if we have exactly 16 bytes, just load them all at once
-        std::string setStr = "";
-        synthesizedHashFunc += "\t\tconst __m128i load = _mm_lddqu_si128((const __m128i *)(key.c_str()));\n";
-    } else {
-        std::string setStr = "";
-        for (size_t i = 0; i < keySize; ++i)
-            setStr += "key[" + std::to_string(i) + "],";
-        for (size_t i = keySize; i < 16; ++i)
-            setStr += "0,";
-        setStr.pop_back();
-        synthesizedHashFunc += "\t\tconst __m128i load = _mm_set_epi8(" + setStr + ");\n";
+    std::string synthesizedHashFunc = "struct synthesizedPextFamily {\n";
+    synthesizedHashFunc += "\tstd::array<std::size_t, " + std::to_string(familySize) + "> operator()(const std::string& key) const {\n";
+
+    for(size_t i = 0; i < layout.size(); i++){
+        synthesizedHashFunc += "\t\tconstexpr std::size_t mask" + std::to_string(i) + " = 0x" + layout[i].mask + ";\n";
+    }
+    for(size_t i = 0; i < layout.size(); i++){
+        synthesizedHashFunc += hashablePext(i, layout[i].offset);
     }
 
-    synthesizedHashFunc += "\t\tconst __m128i hash = _mm_aesenc_si128(load, roundkey);\n";
-    synthesizedHashFunc += "\t\treturn _mm_extract_epi64(hash , 0) ^ _mm_extract_epi64(hash, 1); \n";
+    // Pairs of loads are multiplied, so an odd load is paired with a seed only
+    const size_t slots = layout.size() + layout.size() % 2;
+    synthesizedHashFunc += "\t\tstd::array<std::size_t, " + std::to_string(familySize) + "> hashes;\n";
+    synthesizedHashFunc += "\t\t__uint128_t product;\n";
+    for(size_t hashID = 0; hashID < familySize; hashID++){
+        const std::string hash = "hashes[" + std::to_string(hashID) + "]";
+        for(size_t slot = 0; slot < slots; slot += 2){
+            char seeds[2][19];
+            sprintf(seeds[0], "0x%016lx", familySeed(hashID, slot));
+            sprintf(seeds[1], "0x%016lx", familySeed(hashID, slot + 1));
+            const std::string second = slot + 1 < layout.size() ? "(hashable" + std::to_string(slot + 1) + " ^ " + seeds[1] + ")"
+                                                                : std::string(seeds[1]);
+            synthesizedHashFunc += "\t\tproduct = (__uint128_t)(hashable" + std::to_string(slot) + " ^ " + seeds[0] + ") * " + second + ";\n";
+            synthesizedHashFunc += "\t\t" + hash + (slot ? " ^= " : " = ") + "(std::size_t)product ^ (std::size_t)(product >> 64);\n";
+        }
+    }
+    synthesizedHashFunc += "\t\treturn hashes;\n";
+    synthesizedHashFunc += "\t}\n};\n\n";
+
+    // Functor of each hash function, the unused ones are optimized away
+    synthesizedHashFunc += "template <std::size_t i>\n";
+    synthesizedHashFunc += "struct synthesizedFamilyHash {\n\tstd::size_t operator()(const std::string& key) const {\n";
+    synthesizedHashFunc += "\t\treturn synthesizedPextFamily{}(key)[i];\n";
     synthesizedHashFunc += "\t}\n};\n";
-    synthesizedHashFunc = "#include <immintrin.h>\n#include <wmmintrin.h>\n" + synthesizedHashFunc;
 
     return synthesizedHashFunc;
 }
 
 /**
- * @brief Entry point of the program.
+ * @brief Maximum number of lookup tables of the table-lookup hash function. Further positions share them.
+ */
+constexpr size_t LOOKUP_MAX_TABLES = 16;
+
+/**
+ * @brief Synthesize a table-lookup hash function, in the style of gperf's asso_values tables.
  *
- * This is the main function of the program. It processes command line arguments, which are expected to be a regular expression representing the key format.
- * The regular expression should be generated by the keybuilder component of this project.
- * The function then initiates the appropriate processes based on the provided arguments.
+ * The positions that tell the keys apart the most get their own table: the ones with the highest entropy if keybuilder
+ * printed it, or else the ones with the widest masks. Each character is masked, indexes a small table of random
+ * entries, and the entries are summed. The sum carries between bits, so it does not cancel out like the XOR of OffXor,
+ * and it needs neither PEXT nor AES instructions. Each table has only as many entries as its masks allow, e.g. 16 for
+ * digits, so all of them stay in the L1 cache. Past LOOKUP_MAX_TABLES positions, every position shares the table of a
+ * higher-scored one, and its entries are rotated by a different amount on every pass over the tables, so no variable
+ * position is left unread.
  *
- * @param argc The count of command line arguments.
- * @param argv An array of command line arguments.
- * @return int Returns zero upon successful program execution, non-zero values indicate an error.
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param entropy The entropy of every position, printed by keybuilder. May be empty.
+ * @param entryBits The width of the table entries, 32, or 16 for tables half as large.
+ * @return std::string The synthesized table-lookup hash function as a string.
  */
-int main(int argc, char** argv){
-
-    std::string regexStr = std::string(argv[1]);
+std::string synthetizeLookupHashFunc(std::vector<Range>& ranges, size_t offset, const std::vector<double>& entropy,
+                                     int entryBits = 32){
+
+    // Mask of every position of the key
+    std::vector<unsigned char> masks(offset, 0);
+    for(const auto& range : ranges){
+        for(size_t i = 0; i < range.repetition && range.offset + i < offset; i++){
+            masks[range.offset + i] = range.mask;
+        }
+    }
 
-    // Create ranges
+    std::vector<size_t> positions;
+    for(size_t i = 0; i < offset; i++){
+        if(masks[i] != 0){
+            positions.push_back(i);
+        }
+    }
+    auto score = [&](size_t position){
+        return entropy.size() == offset ? entropy[position] : (double)__builtin_popcount(masks[position]);
+    };
+    std::stable_sort(positions.begin(), positions.end(), [&](size_t a, size_t b){ return score(a) > score(b); });
+    const size_t numTables = std::min(positions.size(), LOOKUP_MAX_TABLES);
+    std::sort(positions.begin(), positions.begin() + numTables);
+
+    // The i-th position reads table i % LOOKUP_MAX_TABLES, which has an entry for the masks of all its positions
+    std::vector<unsigned char> tableMasks(numTables, 0);
+    for(size_t i = 0; i < positions.size(); i++){
+        tableMasks[i % LOOKUP_MAX_TABLES] |= masks[positions[i]];
+    }
+
+    const std::string entryType = "uint" + std::to_string(entryBits) + "_t";
+    std::string synthesizedHashFunc = std::string("struct ") + (entryBits == 16 ? "synthesizedLookup16Hash" : "synthesizedLookupHash") +
+                                      " {\n\tstd::size_t operator()(const std::string& key) const {\n";
+
+    // Random tables, generated once with splitmix64
+    size_t state = 0x9e3779b97f4a7c15;
+    for(size_t tableID = 0; tableID < numTables; tableID++){
+        const size_t tableSize = (size_t)tableMasks[tableID] + 1;
+        synthesizedHashFunc += "\t\tstatic constexpr " + entryType + " table" + std::to_string(tableID) + "[" + std::to_string(tableSize) + "] = {";
+        for(size_t entry = 0; entry < tableSize; entry++){
+            size_t z = (state += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            z ^= z >> 31;
+            char entryStr[12];
+            sprintf(entryStr, entryBits == 16 ? "0x%04lx" : "0x%08lx", z & (entryBits == 16 ? 0xffff : 0xffffffff));
+            synthesizedHashFunc += std::string(entry % 8 == 0 ? "\n\t\t\t" : " ") + entryStr + ",";
+        }
+        synthesizedHashFunc += "\n\t\t};\n";
+    }
+
+    // Entries of the shared tables are rotated, so equal characters at two positions sharing a table add up differently
+    std::vector<std::string> terms;
+    for(size_t i = 0; i < positions.size(); i++){
+        const std::string lookup = "table" + std::to_string(i % LOOKUP_MAX_TABLES) + "[(unsigned char)key[" +
+                                   std::to_string(positions[i]) + "] & 0x" + intToHex(masks[positions[i]]) + "]";
+        const int rotation = (7 * (i / LOOKUP_MAX_TABLES)) % entryBits;
+        if(rotation == 0){
+            terms.push_back(lookup);
+            continue;
+        }
+        const std::string entry = "entry" + std::to_string(i);
+        synthesizedHashFunc += "\t\tconst " + entryType + " " + entry + " = " + lookup + ";\n";
+        terms.push_back("(" + entryType + ")(" + entry + " << " + std::to_string(rotation) + " | " + entry + " >> " +
+                        std::to_string(entryBits - rotation) + ")");
+    }
+
+    synthesizedHashFunc += "\t\tconst uint32_t hash = ";
+    for(size_t i = 0; i < terms.size(); i++){
+        synthesizedHashFunc += (i ? "\n\t\t\t+ " : "") + terms[i];
+    }
+    synthesizedHashFunc += ";\n";
+    synthesizedHashFunc += "\t\treturn hash;\n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Average number of keys per bucket of the minimal perfect hash function is log2(n) / MPH_BUCKET_FACTOR.
+ */
+constexpr double MPH_BUCKET_FACTOR = 6.0;
+
+/**
+ * @brief Maximum pilot tried for each bucket of the minimal perfect hash function.
+ */
+constexpr size_t MPH_MAX_PILOT = 1 << 24;
+
+// Murmur3's 64 bits finalizer, spreads the first-level hash before choosing buckets and positions
+static size_t mphMix(size_t x){
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53;
+    x ^= x >> 33;
+    return x;
+}
+
+// Maps x to [0, n) without a division
+static size_t mphRange(size_t x, size_t n){
+    return ((__uint128_t)x * n) >> 64;
+}
+
+// Position of a key, given its mixed first-level hash and the pilot of its bucket
+static size_t mphPosition(size_t mixed, size_t pilot, size_t numKeys){
+    return mphRange(mphMix(mixed ^ (pilot * 0x9e3779b97f4a7c15)), numKeys);
+}
+
+// Portable PEXT, so keysynth evaluates the synthesized functions on any machine
+static size_t softwarePext(size_t value, size_t mask){
+    size_t extracted = 0;
+    for(size_t bit = 1; mask != 0; mask &= mask - 1, bit <<= 1){
+        if(value & mask & -mask){
+            extracted |= bit;
+        }
+    }
+    return extracted;
+}
+
+/**
+ * @brief Builds the pilots of a minimal perfect hash function, in the style of PTHash.
+ *
+ * Keys are split into buckets by their first-level hash. Starting from the largest bucket, every bucket searches for
+ * the smallest pilot that sends all of its keys to free positions of a table with exactly one position per key.
+ *
+ * @param hashes The distinct first-level hashes of the keys.
+ * @param numBuckets The number of buckets.
+ * @param pilots The pilot of every bucket, filled by this function.
+ * @return true If a pilot was found for every bucket.
+ * @return false Otherwise.
+ */
+static bool buildMinimalPerfectHash(const std::vector<size_t>& hashes, size_t numBuckets, std::vector<size_t>& pilots){
+    const size_t numKeys = hashes.size();
+    std::vector<std::vector<size_t>> buckets(numBuckets);
+    for(const auto& hash : hashes){
+        const size_t mixed = mphMix(hash);
+        buckets[mphRange(mixed, numBuckets)].push_back(mixed);
+    }
+    std::vector<size_t> order(numBuckets);
+    for(size_t i = 0; i < numBuckets; i++){
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return buckets[a].size() > buckets[b].size(); });
+
+    pilots.assign(numBuckets, 0);
+    std::vector<bool> taken(numKeys, false);
+    std::vector<size_t> positions;
+    for(const auto& bucketID : order){
+        const std::vector<size_t>& bucket = buckets[bucketID];
+        if(bucket.empty()){
+            break;
+        }
+        size_t pilot = 0;
+        for(; pilot < MPH_MAX_PILOT; pilot++){
+            positions.clear();
+            for(const auto& mixed : bucket){
+                const size_t position = mphPosition(mixed, pilot, numKeys);
+                if(taken[position] || std::find(positions.begin(), positions.end(), position) != positions.end()){
+                    break;
+                }
+                positions.push_back(position);
+            }
+            if(positions.size() == bucket.size()){
+                break;
+            }
+        }
+        if(pilot == MPH_MAX_PILOT){
+            return false;
+        }
+        for(const auto& position : positions){
+            taken[position] = true;
+        }
+        pilots[bucketID] = pilot;
+    }
+    return true;
+}
+
+/**
+ * @brief Synthesize a minimal perfect hash function for a closed set of keys.
+ *
+ * The first-level hash is the synthesized PEXT hash function, which must not collide on the keys. It is mixed to pick
+ * a bucket, and mixed again with the bucket's pilot to pick the position of the key among [0, n). The lookup costs the
+ * PEXT hash, two mixes, and one load from the pilots array, without branches.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param keys The closed set of keys.
+ * @return std::string The synthesized minimal perfect hash function as a string, or an empty string if it can not be built.
+ */
+std::string synthetizeMinimalPerfectHashFunc(std::vector<Range>& ranges, size_t offset, std::vector<std::string> keys){
+
+    std::vector<PextLoad> layout = calculatePextLayout(ranges, offset);
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    // Evaluate the PEXT hash function on the keys
+    std::vector<size_t> hashes;
+    for(const auto& key : keys){
+        if(key.size() < offset){
+            fprintf(stderr, "Key \"%s\" is shorter than the regex.\n", key.c_str());
+            return "";
+        }
+        size_t hash = 0;
+        for(const auto& load : layout){
+            size_t value;
+            memcpy(&value, key.c_str() + load.offset, sizeof(value));
+            hash ^= softwarePext(value, std::stoull(load.mask, nullptr, 16)) << load.shift;
+        }
+        hashes.push_back(hash);
+    }
+    std::vector<size_t> sortedHashes = hashes;
+    std::sort(sortedHashes.begin(), sortedHashes.end());
+    if(std::adjacent_find(sortedHashes.begin(), sortedHashes.end()) != sortedHashes.end()){
+        fprintf(stderr, "The PEXT hash function collides on the keys, so it can not be the first level of a perfect hash.\n");
+        return "";
+    }
+
+    const size_t numKeys = hashes.size();
+    const size_t numBuckets = std::max<size_t>(1, std::ceil(MPH_BUCKET_FACTOR * numKeys / std::max(1.0, std::log2(numKeys))));
+    std::vector<size_t> pilots;
+    if(!buildMinimalPerfectHash(hashes, numBuckets, pilots)){
+        fprintf(stderr, "No pilot up to %lu places every bucket of the minimal perfect hash.\n", MPH_MAX_PILOT);
+        return "";
+    }
+    const size_t maxPilot = *std::max_element(pilots.begin(), pilots.end());
+    const std::string pilotType = maxPilot <= 0xff ? "uint8_t" : maxPilot <= 0xffff ? "uint16_t" : "uint32_t";
+
+    std::string synthesizedHashFunc = "// Minimal perfect hash of " + std::to_string(numKeys) + " keys into [0, " +
+                                      std::to_string(numKeys) + "). Other keys get any position, so compare the stored key.\n";
+    synthesizedHashFunc += "struct synthesizedMinimalPerfectHash {\n";
+    synthesizedHashFunc += "\tstatic constexpr std::size_t numKeys = " + std::to_string(numKeys) + ";\n";
+    synthesizedHashFunc += "\tstatic constexpr std::size_t numBuckets = " + std::to_string(numBuckets) + ";\n";
+    synthesizedHashFunc += "\tstatic constexpr " + pilotType + " pilots[numBuckets] = {";
+    for(size_t i = 0; i < numBuckets; i++){
+        synthesizedHashFunc += (i % 16 == 0 ? "\n\t\t" : " ") + std::to_string(pilots[i]) + ",";
+    }
+    synthesizedHashFunc += "\n\t};\n\n";
+    synthesizedHashFunc += "\tstatic std::size_t mix(std::size_t x) {\n"
+                           "\t\tx ^= x >> 33;\n"
+                           "\t\tx *= 0xff51afd7ed558ccd;\n"
+                           "\t\tx ^= x >> 33;\n"
+                           "\t\tx *= 0xc4ceb9fe1a85ec53;\n"
+                           "\t\tx ^= x >> 33;\n"
+                           "\t\treturn x;\n"
+                           "\t}\n\n";
+    synthesizedHashFunc += "\tstd::size_t operator()(const std::string& key) const {\n";
+    synthesizedHashFunc += "\t\tconst std::size_t mixed = mix(synthesizedPextHash{}(key));\n";
+    synthesizedHashFunc += "\t\tconst std::size_t pilot = pilots[((__uint128_t)mixed * numBuckets) >> 64];\n";
+    synthesizedHashFunc += "\t\treturn ((__uint128_t)mix(mixed ^ (pilot * 0x9e3779b97f4a7c15)) * numKeys) >> 64;\n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Synthesize a PEXT hash function of fields embedded in larger records.
+ *
+ * Instead of a std::string holding only the key, the functions take a pointer to the record. `hash_at` runs the loads of
+ * the PEXT hash function from the offset of the field, and `hash_field` first finds the start of the N-th field of a
+ * delimited record, such as a CSV row or a log line. The delimiters are counted 16 bytes at a time with SSE2 compares
+ * and popcount, so no copy of the field is made.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @return std::string The synthesized embedded field hash functions as a string.
+ */
+std::string synthetizeEmbeddedHashFunc(std::vector<Range>& ranges, size_t offset){
+
+    std::vector<PextLoad> layout = calculatePextLayout(ranges, offset);
+
+    std::string synthesizedHashFunc = "struct synthesizedEmbeddedPextHash {\n";
+    synthesizedHashFunc += "\tstatic constexpr std::size_t fieldSize = " + std::to_string(offset) + ";\n\n";
+
+    synthesizedHashFunc += "\t// Hashes the field of fieldSize bytes starting at record + field_offset\n";
+    synthesizedHashFunc += "\tstd::size_t hash_at(const char* record, std::size_t field_offset) const {\n";
+    synthesizedHashFunc += "\t\tconst char* field = record + field_offset;\n";
+    for(size_t i = 0; i < layout.size(); i++){
+        synthesizedHashFunc += "\t\tconstexpr std::size_t mask" + std::to_string(i) + " = 0x" + layout[i].mask + ";\n";
+    }
+    std::queue<std::string> queue;
+    for(size_t i = 0; i < layout.size(); i++){
+        synthesizedHashFunc += hashablePext(i, layout[i].offset, "field");
+        const std::string shifted = "hashable" + std::to_string(i) + (layout[i].shift ? " << " + std::to_string(layout[i].shift) : "");
+        synthesizedHashFunc += "\t\tsize_t shift" + std::to_string(i) + " = " + shifted + ";\n";
+        queue.push("shift" + std::to_string(i));
+    }
+    synthesizedHashFunc += cascadeXorVars(queue);
+    synthesizedHashFunc += "\t\treturn " + queue.front() + "; \n";
+    synthesizedHashFunc += "\t}\n\n";
+
+    synthesizedHashFunc += "\t// Returns the start of the field after the field_index-th delimiter, or nullptr if the record is too short\n";
+    synthesizedHashFunc += "\tstatic const char* find_field(const char* record, std::size_t record_size, std::size_t field_index, char delimiter) {\n";
+    synthesizedHashFunc += "\t\tstd::size_t pos = 0;\n";
+    synthesizedHashFunc += "\t\tif (field_index > 0) {\n";
+    synthesizedHashFunc += "\t\t\tconst __m128i delimiters = _mm_set1_epi8(delimiter);\n";
+    synthesizedHashFunc += "\t\t\tstd::size_t remaining = field_index;\n";
+    synthesizedHashFunc += "\t\t\tfor (; pos + 16 <= record_size; pos += 16) {\n";
+    synthesizedHashFunc += "\t\t\t\tconst __m128i chars = _mm_loadu_si128((const __m128i *)(record + pos));\n";
+    synthesizedHashFunc += "\t\t\t\tunsigned found = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, delimiters));\n";
+    synthesizedHashFunc += "\t\t\t\tconst std::size_t count = __builtin_popcount(found);\n";
+    synthesizedHashFunc += "\t\t\t\tif (count >= remaining) {\n";
+    synthesizedHashFunc += "\t\t\t\t\tfor (; remaining > 1; remaining--) {\n";
+    synthesizedHashFunc += "\t\t\t\t\t\tfound &= found - 1;\n";
+    synthesizedHashFunc += "\t\t\t\t\t}\n";
+    synthesizedHashFunc += "\t\t\t\t\tpos += __builtin_ctz(found) + 1;\n";
+    synthesizedHashFunc += "\t\t\t\t\tremaining = 0;\n";
+    synthesizedHashFunc += "\t\t\t\t\tbreak;\n";
+    synthesizedHashFunc += "\t\t\t\t}\n";
+    synthesizedHashFunc += "\t\t\t\tremaining -= count;\n";
+    synthesizedHashFunc += "\t\t\t}\n";
+    synthesizedHashFunc += "\t\t\tfor (; remaining > 0 && pos < record_size; pos++) {\n";
+    synthesizedHashFunc += "\t\t\t\tremaining -= record[pos] == delimiter;\n";
+    synthesizedHashFunc += "\t\t\t}\n";
+    synthesizedHashFunc += "\t\t\tif (remaining > 0) {\n";
+    synthesizedHashFunc += "\t\t\t\treturn nullptr;\n";
+    synthesizedHashFunc += "\t\t\t}\n";
+    synthesizedHashFunc += "\t\t}\n";
+    synthesizedHashFunc += "\t\treturn pos + fieldSize <= record_size ? record + pos : nullptr;\n";
+    synthesizedHashFunc += "\t}\n\n";
+
+    synthesizedHashFunc += "\t// Hashes the field after the field_index-th delimiter. Records without the field hash to 0\n";
+    synthesizedHashFunc += "\tstd::size_t hash_field(const char* record, std::size_t record_size, std::size_t field_index, char delimiter = ',') const {\n";
+    synthesizedHashFunc += "\t\tconst char* field = find_field(record, record_size, field_index, delimiter);\n";
+    synthesizedHashFunc += "\t\treturn field ? hash_at(field, 0) : 0;\n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Synthesize a hash function that only runs the Pext hash function on keys that conform to the layout.
+ *
+ * A layout inferred with `keybuilder --outliers` ignores the rarest symbols, so its masks may drop bits that the
+ * outlier keys do change. Every bit that is the same across the conforming keys, in the OR and the AND masks, is checked
+ * with one load per 8 bytes before hashing, and keys that differ, or have another size, go to std::hash instead.
+ *
+ * @param orMask The OR of every position, printed by keybuilder.
+ * @param andMask The AND of every position, printed by keybuilder.
+ * @return std::string The synthesized guarded hash function as a string.
+ */
+std::string synthetizeGuardedHashFunc(const std::string& orMask, const std::string& andMask){
+
+    const size_t keySize = orMask.size() / 2;
+    std::vector<size_t> offsets;
+    for(size_t offset = 0; offset + 8 < keySize; offset += 8){
+        offsets.push_back(offset);
+    }
+    offsets.push_back(keySize - 8);
+
+    std::string synthesizedHashFunc = "struct synthesizedGuardedPextHash {\n";
+    synthesizedHashFunc += "\t// Whether every bit that is the same in all the conforming keys has its usual value\n";
+    synthesizedHashFunc += "\tstatic bool conforms(const std::string& key) {\n";
+    synthesizedHashFunc += "\t\tif (key.size() != " + std::to_string(keySize) + ") {\n";
+    synthesizedHashFunc += "\t\t\treturn false;\n";
+    synthesizedHashFunc += "\t\t}\n";
+    std::string differences;
+    for(size_t i = 0; i < offsets.size(); i++){
+        size_t fixed = 0;
+        size_t value = 0;
+        for(size_t byte = 0; byte < 8; byte++){
+            const size_t pos = offsets[i] + byte;
+            const unsigned orByte = std::stoul(orMask.substr(2 * pos, 2), nullptr, 16);
+            const unsigned andByte = std::stoul(andMask.substr(2 * pos, 2), nullptr, 16);
+            fixed |= size_t(~(orByte ^ andByte) & 0xff) << (8 * byte);
+            value |= size_t(andByte) << (8 * byte);
+        }
+        value &= fixed;
+        if(fixed == 0){
+            continue;
+        }
+        const std::string id = std::to_string(i);
+        synthesizedHashFunc += "\t\tconst uint64_t word" + id + " = load_u64_le(key.c_str() + " + std::to_string(offsets[i]) + ");\n";
+        differences += std::string(differences.empty() ? "" : " | ") + "((word" + id + " & 0x" + intToHex(fixed) +
+                       ") ^ 0x" + intToHex(value) + ")";
+    }
+    synthesizedHashFunc += "\t\treturn " + (differences.empty() ? std::string("true") : "(" + differences + ") == 0") + ";\n";
+    synthesizedHashFunc += "\t}\n\n";
+    synthesizedHashFunc += "\tstd::size_t operator()(const std::string& key) const {\n";
+    synthesizedHashFunc += "\t\treturn conforms(key) ? synthesizedPextHash{}(key) : std::hash<std::string>{}(key);\n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Synthesize a PEXT hash function for sequential keys, such as counters and timestamps.
+ *
+ * Hash tables pick buckets from the lowest bits of the hash, but the 'NO SKIP TABLE' function compresses loads in
+ * little-endian order, so the last digits of a counter, the ones that change on every key, land in the highest bits
+ * of their load. This function uses the velocity of every position, how often it changes between consecutive keys as
+ * printed by keybuilder, instead. A load is byte swapped when its last bytes are faster than its first ones, so they
+ * are compressed into its lowest bits, and the loads are concatenated from the fastest one up. Once the bits run out,
+ * the slowest loads are XORed into the highest bits.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param velocity The velocity of every position of the key.
+ * @return std::string The synthesized PEXT hash function as a string.
+ */
+std::string synthetizeVelocityPextHashFunc(std::vector<Range>& ranges, size_t offset, const std::vector<double>& velocity){
+
+    struct VelocityLoad{
+        size_t offset; ///< Offset of the 8 bytes load in the key.
+        size_t mask; ///< PEXT mask of the load, already byte swapped if the load is.
+        bool swapped; ///< Whether the load is byte swapped.
+        double velocity; ///< Velocity of the fastest position of the load.
+    };
+
+    std::vector<VelocityLoad> loads;
+    for(const auto& load : calculatePextLayout(ranges, offset)){
+        const size_t mask = std::stoull(load.mask, nullptr, 16);
+        double first = -1.0, last = -1.0, fastest = 0.0;
+        for(size_t byte = 0; byte < 8; byte++){
+            const size_t pos = load.offset + byte;
+            if(((mask >> (8 * byte)) & 0xff) == 0 || pos >= velocity.size()){
+                continue;
+            }
+            first = first < 0.0 ? velocity[pos] : first;
+            last = velocity[pos];
+            fastest = std::max(fastest, velocity[pos]);
+        }
+        const bool swapped = last > first;
+        loads.push_back({load.offset, swapped ? __builtin_bswap64(mask) : mask, swapped, fastest});
+    }
+    std::stable_sort(loads.begin(), loads.end(), [](const VelocityLoad& a, const VelocityLoad& b){
+        return a.velocity > b.velocity;
+    });
+
+    std::string synthesizedHashFunc = "struct synthesizedVelocityPextHash {\n";
+    synthesizedHashFunc += "\tstd::size_t operator()(const std::string& key) const {\n";
+    for(size_t i = 0; i < loads.size(); i++){
+        synthesizedHashFunc += "\t\tconstexpr std::size_t mask" + std::to_string(i) + " = 0x" + intToHex(loads[i].mask) + ";\n";
+    }
+
+    // Fastest loads first, each one right above the bits of the previous ones
+    std::queue<std::string> queue;
+    int usedBits = 0;
+    for(size_t i = 0; i < loads.size(); i++){
+        const std::string id = std::to_string(i);
+        const std::string word = "load_u64_le(key.c_str()+" + std::to_string(loads[i].offset) + ")";
+        synthesizedHashFunc += "\t\tconst std::size_t hashable" + id + " = _pext_u64(" +
+                               (loads[i].swapped ? "__builtin_bswap64(" + word + ")" : word) + ", mask" + id + ");\n";
+        const int bits = 64 - countZeros(loads[i].mask);
+        const int shift = usedBits + bits <= 64 ? usedBits : 64 - bits;
+        usedBits += bits;
+        synthesizedHashFunc += "\t\tsize_t shift" + id + " = hashable" + id + (shift ? " << " + std::to_string(shift) : "") + ";\n";
+        queue.push("shift" + id);
+    }
+
+    synthesizedHashFunc += cascadeXorVars(queue);
+    synthesizedHashFunc += "\t\treturn " + queue.front() + ";\n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Clear the case bit of the masks of the positions that may hold letters.
+ *
+ * ASCII letters only differ from their other case in bit 0x20, so PEXT masks without it hash both cases of a letter
+ * alike. Digits keep bit 0x10 and lose 0x40, while letters keep 0x40, so positions mixing both, like the hexadecimal
+ * digits of MAC addresses, still tell digits and letters apart.
+ *
+ * @param ranges The vector of Range objects, whose masks are folded.
+ * @param regex The regular expression string, whose classes tell which positions may hold letters.
+ */
+static void foldCaseRanges(std::vector<Range>& ranges, std::string& regex){
+    std::pair<std::vector<Range>,size_t> classes = calculateRanges(regex);
+    std::vector<bool> letters(classes.second, false);
+    for(const auto& range : classes.first){
+        const bool hasLetters = range.start <= 'z' && range.end >= 'A' && !(range.start > 'Z' && range.end < 'a');
+        for(size_t i = 0; i < range.repetition; i++){
+            letters[range.offset + i] = hasLetters;
+        }
+    }
+    // Observed ranges may be narrower than the classes, but they never cross a class boundary
+    for(auto& range : ranges){
+        if(letters[range.offset]){
+            range.mask &= ~0x20;
+        }
+    }
+}
+
+/**
+ * @brief Synthesize a case-insensitive equality comparator.
+ *
+ * The keys are compared 16 bytes at a time with SSE2. Uppercase letters get their case bit set before the comparison,
+ * so both cases of a letter compare equal, without lowercased copies of the keys. Keys of other sizes than the regex
+ * fall back to a byte by byte comparison.
+ *
+ * @param offset Total key size.
+ * @return std::string The synthesized equality comparator as a string.
+ */
+std::string synthetizeCaseInsensitiveEqualFunc(size_t offset){
+    std::string synthesizedEqualFunc = "struct synthesizedCaseInsensitiveEqual {\n";
+    synthesizedEqualFunc += "\t// Sets the case bit of the bytes in ['A', 'Z'], with a signed comparison of the bytes moved to start at -128\n";
+    synthesizedEqualFunc += "\tstatic __m128i toLower(__m128i chars) {\n";
+    synthesizedEqualFunc += "\t\tconst __m128i moved = _mm_add_epi8(chars, _mm_set1_epi8(128 - 'A'));\n";
+    synthesizedEqualFunc += "\t\tconst __m128i upper = _mm_cmplt_epi8(moved, _mm_set1_epi8(-128 + 26));\n";
+    synthesizedEqualFunc += "\t\treturn _mm_or_si128(chars, _mm_and_si128(upper, _mm_set1_epi8(0x20)));\n";
+    synthesizedEqualFunc += "\t}\n\n";
+    synthesizedEqualFunc += "\tstatic char toLower(char ch) {\n";
+    synthesizedEqualFunc += "\t\treturn ch >= 'A' && ch <= 'Z' ? ch | 0x20 : ch;\n";
+    synthesizedEqualFunc += "\t}\n\n";
+    synthesizedEqualFunc += "\tbool operator()(const std::string& a, const std::string& b) const {\n";
+    synthesizedEqualFunc += "\t\tif (a.size() != b.size()) {\n\t\t\treturn false;\n\t\t}\n";
+    synthesizedEqualFunc += "\t\tif (a.size() != " + std::to_string(offset) + ") {\n";
+    synthesizedEqualFunc += "\t\t\treturn std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return toLower(x) == toLower(y); });\n";
+    synthesizedEqualFunc += "\t\t}\n";
+
+    // Loads of 16 bytes, the last one moved back into the key. Shorter keys are copied into zeroed registers
+    std::vector<size_t> offsets;
+    if(offset < 16){
+        synthesizedEqualFunc += "\t\tchar bufferA[16] = {};\n\t\tchar bufferB[16] = {};\n";
+        synthesizedEqualFunc += "\t\tmemcpy(bufferA, a.data(), " + std::to_string(offset) + ");\n";
+        synthesizedEqualFunc += "\t\tmemcpy(bufferB, b.data(), " + std::to_string(offset) + ");\n";
+        offsets.push_back(0);
+    } else {
+        for(size_t off = 0; off + 16 < offset; off += 16){
+            offsets.push_back(off);
+        }
+        offsets.push_back(offset - 16);
+    }
+    const std::string ptrA = offset < 16 ? "bufferA" : "a.data()";
+    const std::string ptrB = offset < 16 ? "bufferB" : "b.data()";
+
+    std::queue<std::string> queue;
+    for(size_t i = 0; i < offsets.size(); i++){
+        const std::string id = std::to_string(i);
+        const std::string off = std::to_string(offsets[i]);
+        synthesizedEqualFunc += "\t\tconst __m128i diff" + id + " = _mm_xor_si128(toLower(_mm_loadu_si128((const __m128i *)(" + ptrA + "+" + off + "))), "
+                                "toLower(_mm_loadu_si128((const __m128i *)(" + ptrB + "+" + off + "))));\n";
+        queue.push("diff" + id);
+    }
+
+    // Cascade OR variables
+    int tmpID = 0;
+    while(queue.size() > 1){
+        std::string id1 = queue.front();
+        queue.pop();
+        std::string id2 = queue.front();
+        queue.pop();
+        std::string tmpVar = "tmp" + std::to_string(tmpID++);
+        synthesizedEqualFunc += "\t\tconst __m128i " + tmpVar + " = _mm_or_si128(" + id1 + ", " + id2 + ");\n";
+        queue.push(tmpVar);
+    }
+
+    synthesizedEqualFunc += "\t\treturn _mm_movemask_epi8(_mm_cmpeq_epi8(" + queue.front() + ", _mm_setzero_si128())) == 0xffff;\n";
+    synthesizedEqualFunc += "\t}\n};\n";
+
+    return synthesizedEqualFunc;
+}
+
+/**
+ * @brief Synthesize an Offset XOR hash function.
+ *
+ * This function synthesizes an Offset XOR hash function. It does this by taking a vector of Range objects and an offset as input.
+ * This is a naive implementation that just XORs bytes at the given offsets.
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param padding Number of readable bytes after the end of the key. If non-zero, loads have a fixed stride, the bytes
+ *                of the last load past the end of the key are masked off, and the function takes a pointer to the key.
+ * @return std::string The synthesized Offset XOR hash function as a string.
+ */
+std::string synthetizeOffXorHashFunc(std::vector<Range>& ranges, size_t offset, size_t padding = 0){
+
+    // Calculate offsets
+    std::vector<size_t> offsets = padding ? calculatePaddedOffsets(calculateByteMasks(ranges, offset, 8), 8)
+                                          : calculateOffsets(ranges);
+
+    // Avoid out of bounds memory access on the last mask/offset
+    if (!padding && offsets[offsets.size()-1] + 8 >= offset){
+        offsets[offsets.size()-1] = offset - 8;
+    }
+
+    std::string synthesizedHashFunc = "struct synthesizedOffXorHash {\n";
+    synthesizedHashFunc += padding ? "\t// Reads up to 7 bytes past the end of the key, which must be followed by at least " + std::to_string(padding) + " readable bytes\n"
+                                     "\tstd::size_t operator()(const char* key) const {\n"
+                                   : "\tstd::size_t operator()(const std::string& key) const {\n";
+
+    // Create hashables
+    int hashableID = 0;
+    for(const auto& off : offsets){
+        synthesizedHashFunc += hashableNaive(hashableID++, off, padding ? "key" : "key.c_str()");
+    }
+
+    // Mask off the bytes past the end of the key
+    if(padding && offsets.back() + 8 > offset){
+        const std::string last = "hashable" + std::to_string(hashableID - 1);
+        synthesizedHashFunc += "\t\tconst std::size_t tail = " + last + " & 0x" + tailMask(offsets.back(), offset) + ";\n";
+    }
+
+    // Create queue of "XORable" variables
+    std::queue<std::string> queue;
+    for (int i = 0; i < hashableID; ++i) {
+        const bool masked = padding && i == hashableID - 1 && offsets.back() + 8 > offset;
+        queue.push(masked ? "tail" : "hashable" + std::to_string(i));
+    }
+
+    // Cascade XOR variables
+    synthesizedHashFunc += cascadeXorVars(queue);
+
+    synthesizedHashFunc += "\t\treturn " + queue.front() + "; \n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Synthesize an Aes Hash Function.
+ *
+ * This function synthesizes an Aes hash function. It does this by taking a vector of Range objects and an offset as input.
+ * This is an implementation that keeps reducing the number of available bytes by repeatedly calling Aes instructions
+ *
+ * @param ranges The vector of Range objects.
+ * @param offset Total key size to use as a base in offset calculation
+ * @param padding Number of readable bytes after the end of the key. If non-zero, loads have a fixed stride, the bytes
+ *                of the last load past the end of the key are masked off, and the function takes a pointer to the key.
+ *                Keys of up to 16 bytes are then hashed with a single load.
+ * @return std::string The synthesized Offset XOR SIMD hash function as a string.
+ */
+std::string synthetizeAesHashFunc(std::vector<Range>& ranges, size_t offset, size_t padding = 0) {
+    // Calculate offsets
+    std::vector<size_t> offsets = padding ? calculatePaddedOffsets(calculateByteMasks(ranges, offset, 16), 16)
+                                          : calculateOffsets(ranges, 16);
+
+    // Avoid out of bounds memory access on the last mask/offset
+    if (!padding && offsets[offsets.size()-1] + 16 >= offset){
+        offsets[offsets.size()-1] = offset - 16;
+    }
+
+    std::string synthesizedHashFunc = "struct synthesizeAesHash {\n";
+    synthesizedHashFunc += padding ? "\t// Reads up to 15 bytes past the end of the key, which must be followed by at least " + std::to_string(padding) + " readable bytes\n"
+                                     "\tstd::size_t operator()(const char* key) const {\n"
+                                   : "\tstd::size_t operator()(const std::string& key) const {\n";
+
+    // Create hashables
+    int hashableID = 0;
+    for(const auto& off : offsets){
+        synthesizedHashFunc += hashableNaiveSIMD(hashableID++, off, padding ? "key" : "key.c_str()");
+    }
+
+    // Mask off the bytes past the end of the key
+    const bool masked = padding && offsets.back() + 16 > offset;
+    if(masked){
+        const std::string last = "hashable" + std::to_string(hashableID - 1);
+        const std::string low = tailMask(offsets.back(), offset);
+        const std::string high = offsets.back() + 8 < offset ? tailMask(offsets.back() + 8, offset) : "0000000000000000";
+        synthesizedHashFunc += "\t\tconst __m128i tail = _mm_and_si128(" + last + ", _mm_set_epi64x(0x" + high + ", 0x" + low + "));\n";
+    }
+
+    // A single load is mixed with a round key, as keys of up to 16 bytes are
+    if(padding && hashableID == 1){
+        synthesizedHashFunc += "\t\t// chosen by a fair roll of the dice\n";
+        synthesizedHashFunc += "\t\tconst __m128i roundkey = _mm_set_epi64x(0xFB6D468E93C391E2 , 0x9c06f0be6f44851b);\n";
+        synthesizedHashFunc += "\t\tconst __m128i hash = _mm_aesenc_si128(" + std::string(masked ? "tail" : "hashable0") + ", roundkey);\n";
+        synthesizedHashFunc += "\t\treturn _mm_extract_epi64(hash , 0) ^ _mm_extract_epi64(hash, 1); \n";
+        synthesizedHashFunc += "\t}\n};\n";
+        return "#include <immintrin.h>\n#include <wmmintrin.h>\n" + synthesizedHashFunc;
+    }
+
+    // Create queue of "AESable" variables
+    std::queue<std::string> queue;
+    for (int i = 0; i < hashableID; ++i) {
+        queue.push(masked && i == hashableID - 1 ? "tail" : "hashable" + std::to_string(i));
+    }
+
+    // Cascade XOR variables
+    synthesizedHashFunc += cascadeAesVars(queue);
+
+    synthesizedHashFunc += "\t\treturn _mm_extract_epi64("+queue.front()+", 0) ^ _mm_extract_epi64("+queue.front()+" , 1); \n";
+    synthesizedHashFunc += "\t}\n};\n";
+    synthesizedHashFunc = "#include <immintrin.h>\n#include <wmmintrin.h>\n" + synthesizedHashFunc;
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Synthesize an Aes Hash Function for keys of size < 16.
+ *
+ * This function does the same as the synthesizedHashFunc, but deals with the special case of the key's size
+ * being smaller of equal to 16
+ *
+ * @param ranges The vector of Range objects.
+ * @param regexSize The full key's size.
+ * @return std::string The synthesized Offset XOR SIMD hash function as a string.
+ */
+std::string synthetizeAesHashFuncLe16bytes(size_t keySize) {
+    keySize = keySize > 16 ? 16 : keySize;
+
+    std::string synthesizedHashFunc = "struct synthesizeAesHash {\n\tstd::size_t operator()(const std::string& key) const {\n";
+    synthesizedHashFunc += "\t\t// chosen by a fair roll of the dice\n";
+    synthesizedHashFunc += "\t\tconst __m128i roundkey = _mm_set_epi64x(0xFB6D468E93C391E2 , 0x9c06f0be6f44851b);\n";
+
+    if (keySize == 16) {
+        // if we have exactly 16 bytes, just load them all at once
+        std::string setStr = "";
+        synthesizedHashFunc += "\t\tconst __m128i load = _mm_lddqu_si128((const __m128i *)(key.c_str()));\n";
+    } else {
+        std::string setStr = "";
+        for (size_t i = 0; i < keySize; ++i)
+            setStr += "key[" + std::to_string(i) + "],";
+        for (size_t i = keySize; i < 16; ++i)
+            setStr += "0,";
+        setStr.pop_back();
+        synthesizedHashFunc += "\t\tconst __m128i load = _mm_set_epi8(" + setStr + ");\n";
+    }
+
+    synthesizedHashFunc += "\t\tconst __m128i hash = _mm_aesenc_si128(load, roundkey);\n";
+    synthesizedHashFunc += "\t\treturn _mm_extract_epi64(hash , 0) ^ _mm_extract_epi64(hash, 1); \n";
+    synthesizedHashFunc += "\t}\n};\n";
+    synthesizedHashFunc = "#include <immintrin.h>\n#include <wmmintrin.h>\n" + synthesizedHashFunc;
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @struct TokenField
+ * @brief A field of a tokenized key, between two delimiters, as printed by `keybuilder --tokenize`.
+ */
+struct TokenField{
+    std::string literal; ///< Text of a constant field. Empty for variable fields.
+    char start = 0; ///< First character of the class of a variable field. Zero for constant fields.
+    char end = 0; ///< Last character of the class of a variable field.
+    size_t minLength = 0; ///< Minimum length of a variable field.
+    size_t maxLength = 0; ///< Maximum length of a variable field.
+};
+
+/**
+ * @brief Whether a regex has fields of variable length, such as [0-9]{1,3}.
+ *
+ * @param regex The regular expression string.
+ * @return true If some repetition of the regex is a {m,n} range.
+ * @return false Otherwise.
+ */
+static bool isTokenizedRegex(const std::string& regex){
+    for(size_t i = regex.find('{'); i != std::string::npos; i = regex.find('{', i + 1)){
+        size_t digitsEnd = regex.find_first_not_of("0123456789", i + 1);
+        if(digitsEnd != std::string::npos && digitsEnd > i + 1 && regex[digitsEnd] == ','){
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Split a tokenized regex into its fields.
+ *
+ * Delimiters, escaped or not, end the current field. A class ends a field of variable characters, and other characters
+ * are the text of a constant field. A field mixing both is widened into a single variable field.
+ *
+ * @param regex The regular expression string, generated by `keybuilder --tokenize`.
+ * @param delimiters The characters that split the fields.
+ * @param fieldDelimiters Filled with the delimiter after every field but the last one.
+ * @return std::vector<TokenField> The fields of the regex, in order.
+ */
+static std::vector<TokenField> calculateTokenFields(const std::string& regex, const std::string& delimiters,
+                                                    std::string& fieldDelimiters){
+    std::vector<TokenField> fields(1);
+    for(size_t i = 0; i < regex.size(); i++){
+        TokenField& field = fields.back();
+        if(regex[i] == '[' && i + 4 < regex.size()){
+            const char start = regex[i+1];
+            const char end = regex[i+3];
+            size_t minLength = 1;
+            size_t maxLength = 1;
+            i += 4;
+            if(i + 1 < regex.size() && regex[i+1] == '{'){
+                const size_t closeBracketPos = regex.find('}', i + 2);
+                const std::string repetition = regex.substr(i + 2, closeBracketPos - i - 2);
+                const size_t comma = repetition.find(',');
+                minLength = std::stoul(repetition.substr(0, comma));
+                maxLength = comma == std::string::npos ? minLength : std::stoul(repetition.substr(comma + 1));
+                i = closeBracketPos;
+            }
+            field.start = field.start && field.start < start ? field.start : start;
+            field.end = field.end > end ? field.end : end;
+            field.minLength += minLength;
+            field.maxLength += maxLength;
+            continue;
+        }
+        const char ch = regex[i] == '\\' && i + 1 < regex.size() ? regex[++i] : regex[i];
+        if(delimiters.find(ch) != std::string::npos){
+            fieldDelimiters += ch;
+            fields.emplace_back();
+        } else {
+            field.literal += ch;
+        }
+    }
+
+    for(auto& field : fields){
+        if(field.start && !field.literal.empty()){
+            for(const char ch : field.literal){
+                field.start = ch < field.start ? ch : field.start;
+                field.end = ch > field.end ? ch : field.end;
+            }
+            field.minLength += field.literal.size();
+            field.maxLength += field.literal.size();
+            field.literal.clear();
+        }
+    }
+    return fields;
+}
+
+/**
+ * @brief Synthesize a delimiter-anchored hash function for keys whose fields have variable lengths.
+ *
+ * The delimiters are found first, with SSE2 compares into a bitmask that is walked with ctz. Keys of up to 16 bytes are
+ * compared straight from two registers, keys of up to 64 bytes are copied into a zeroed buffer first, and longer keys
+ * are searched with memchr instead. Every variable field is then loaded
+ * 8 bytes at a time, masked to its length, and compressed with the PEXT mask of its class. The compressed field and its length are rotated to the next free bits of the hash, so
+ * if all fields fit in 64 bits the hash is injective over the keys of the regex. Constant fields are skipped.
+ *
+ * @param fields The fields of the key, in order.
+ * @param fieldDelimiters The delimiter after every field but the last one.
+ * @return std::string The synthesized tokenized hash function as a string.
+ */
+std::string synthetizeTokenizedHashFunc(const std::vector<TokenField>& fields, const std::string& fieldDelimiters){
+
+    size_t maxKeySize = fieldDelimiters.size();
+    for(const auto& field : fields){
+        maxKeySize += field.start ? field.maxLength : field.literal.size();
+    }
+    std::string uniqueDelimiters;
+    for(const char delimiter : fieldDelimiters){
+        if(uniqueDelimiters.find(delimiter) == std::string::npos){
+            uniqueDelimiters += delimiter;
+        }
+    }
+    auto charLiteral = [](char ch){ return std::string(ch == '\\' || ch == '\'' ? "'\\" : "'") + ch + "'"; };
+    // Keys of up to 16 bytes fit in two registers, and are only indexed by offsets
+    bool inRegisters = maxKeySize <= 16;
+    for(const auto& field : fields){
+        inRegisters = inRegisters && field.maxLength <= 8;
+    }
+    const bool buffered = !inRegisters && maxKeySize <= 64;
+    const size_t numDelimiters = fieldDelimiters.size();
+    const std::string position = inRegisters ? "const std::size_t " : "const char* ";
+
+    std::string synthesizedHashFunc = "struct synthesizedTokenizedPextHash {\n";
+    if(!buffered){
+        synthesizedHashFunc += "\t// Loads the first n bytes at b, up to 8, without reading past end\n";
+        synthesizedHashFunc += "\tstatic uint64_t load_field(const char* b, std::size_t n, const char* end) {\n";
+        synthesizedHashFunc += "\t\tif (end - b >= 8) {\n";
+        synthesizedHashFunc += "\t\t\treturn _bzhi_u64(load_u64_le(b), 8 * std::min<std::size_t>(n, 8));\n";
+        synthesizedHashFunc += "\t\t}\n";
+        synthesizedHashFunc += "\t\tuint64_t value = 0;\n";
+        synthesizedHashFunc += "\t\tmemcpy(&value, b, n);\n";
+        synthesizedHashFunc += "\t\treturn value;\n";
+        synthesizedHashFunc += "\t}\n\n";
+    }
+    synthesizedHashFunc += "\tstd::size_t operator()(const std::string& key) const {\n";
+
+    std::string compares;
+    for(size_t i = 0; i < uniqueDelimiters.size(); i++){
+        const std::string cmp = "_mm_cmpeq_epi8(chars, _mm_set1_epi8(" + charLiteral(uniqueDelimiters[i]) + "))";
+        compares = i == 0 ? cmp : "_mm_or_si128(" + compares + ", " + cmp + ")";
+    }
+    const std::string checkDelimiters = "\t\tif (__builtin_popcountll(delimiters) != " + std::to_string(numDelimiters) + ") {\n"
+                                        "\t\t\treturn std::hash<std::string>{}(key);\n"
+                                        "\t\t}\n";
+    if(inRegisters){
+        synthesizedHashFunc += "\t\tconst std::size_t size = key.size();\n";
+        synthesizedHashFunc += "\t\tif (size > 16) {\n";
+        synthesizedHashFunc += "\t\t\treturn std::hash<std::string>{}(key);\n";
+        synthesizedHashFunc += "\t\t}\n";
+        synthesizedHashFunc += "\t\t// The key is loaded into two registers, the second one overlapping the first and shifted to drop the overlap\n";
+        synthesizedHashFunc += "\t\tuint64_t low = 0;\n";
+        synthesizedHashFunc += "\t\tuint64_t high = 0;\n";
+        synthesizedHashFunc += "\t\tif (size >= 8) {\n";
+        synthesizedHashFunc += "\t\t\tlow = load_u64_le(key.data());\n";
+        synthesizedHashFunc += "\t\t\thigh = size > 8 ? load_u64_le(key.data() + size - 8) >> (8 * (16 - size)) : 0;\n";
+        synthesizedHashFunc += "\t\t} else {\n";
+        synthesizedHashFunc += "\t\t\tmemcpy(&low, key.data(), size);\n";
+        synthesizedHashFunc += "\t\t}\n";
+        synthesizedHashFunc += "\t\tconst __uint128_t whole = (__uint128_t)high << 64 | low;\n";
+        synthesizedHashFunc += "\t\tconst __m128i chars = _mm_set_epi64x(high, low);\n";
+        synthesizedHashFunc += "\t\t// Bit i is set if key[i] is a delimiter\n";
+        synthesizedHashFunc += "\t\tuint64_t delimiters = _mm_movemask_epi8(" + compares + ");\n";
+        synthesizedHashFunc += checkDelimiters;
+    } else if(buffered){
+        synthesizedHashFunc += "\t\tif (key.size() > 64) {\n";
+        synthesizedHashFunc += "\t\t\treturn std::hash<std::string>{}(key);\n";
+        synthesizedHashFunc += "\t\t}\n";
+        synthesizedHashFunc += "\t\t// The key is copied into a zeroed buffer, so neither the compares nor the loads read past its end\n";
+        synthesizedHashFunc += "\t\talignas(16) char data[80] = {0};\n";
+        synthesizedHashFunc += "\t\tmemcpy(data, key.data(), key.size());\n";
+        synthesizedHashFunc += "\t\tconst char* end = data + key.size();\n";
+        synthesizedHashFunc += "\t\t// Bit i is set if key[i] is a delimiter\n";
+        synthesizedHashFunc += "\t\tuint64_t delimiters = 0;\n";
+        synthesizedHashFunc += "\t\tfor (std::size_t pos = 0; pos < key.size(); pos += 16) {\n";
+        synthesizedHashFunc += "\t\t\tconst __m128i chars = _mm_load_si128((const __m128i *)(data + pos));\n";
+        synthesizedHashFunc += "\t\t\tdelimiters |= (uint64_t)_mm_movemask_epi8(" + compares + ") << pos;\n";
+        synthesizedHashFunc += "\t\t}\n";
+        synthesizedHashFunc += checkDelimiters;
+    } else {
+        synthesizedHashFunc += "\t\tconst char* data = key.data();\n";
+        synthesizedHashFunc += "\t\tconst char* end = data + key.size();\n";
+    }
+
+    synthesizedHashFunc += "\t\t" + position + "start0 = " + (inRegisters ? "0" : "data") + ";\n";
+    for(size_t i = 0; i < numDelimiters; i++){
+        const std::string id = std::to_string(i);
+        const std::string next = std::to_string(i + 1);
+        if(inRegisters || buffered){
+            synthesizedHashFunc += "\t\t" + position + "end" + id + " = " + (inRegisters ? "" : "data + ") +
+                                   "__builtin_ctzll(delimiters);\n";
+            synthesizedHashFunc += "\t\tdelimiters &= delimiters - 1;\n";
+        } else {
+            synthesizedHashFunc += "\t\tconst char* end" + id + " = (const char*)memchr(start" + id + ", " +
+                                   charLiteral(fieldDelimiters[i]) + ", end - start" + id + ");\n";
+            synthesizedHashFunc += "\t\tif (end" + id + " == nullptr) {\n";
+            synthesizedHashFunc += "\t\t\treturn std::hash<std::string>{}(key);\n";
+            synthesizedHashFunc += "\t\t}\n";
+        }
+        synthesizedHashFunc += "\t\t" + position + "start" + next + " = end" + id + " + 1;\n";
+    }
+    synthesizedHashFunc += "\t\t" + position + "end" + std::to_string(numDelimiters) + " = " + (inRegisters ? "size" : "end") + ";\n";
+
+    synthesizedHashFunc += "\t\tstd::size_t hash = 0;\n";
+    size_t usedBits = 0;
+    for(size_t f = 0; f < fields.size(); f++){
+        const TokenField& field = fields[f];
+        const std::string id = std::to_string(f);
+        if(!field.start){
+            synthesizedHashFunc += "\t\t// field" + id + " is constant, so it is not hashed\n";
+            continue;
+        }
+        const unsigned char classMask = Range(field.start, field.end, 0, 1).mask;
+        const int classBits = __builtin_popcount(classMask);
+        int lengthBits = 0;
+        while((size_t(1) << lengthBits) <= field.maxLength){
+            lengthBits++;
+        }
+
+        synthesizedHashFunc += "\t\tconst std::size_t length" + id + " = end" + id + " - start" + id + ";\n";
+        for(size_t chunk = 0; chunk * 8 < field.maxLength; chunk++){
+            const size_t chunkBytes = std::min<size_t>(8, field.maxLength - chunk * 8);
+            size_t mask = 0;
+            for(size_t byte = 0; byte < chunkBytes; byte++){
+                mask |= size_t(classMask) << (8 * byte);
+            }
+            const std::string chunkID = id + "_" + std::to_string(chunk);
+            const std::string chunkStart = "start" + id + (chunk ? " + " + std::to_string(8 * chunk) : "");
+            const std::string bytes = chunk == 0 ? "length" + id
+                                                 : "(length" + id + " > " + std::to_string(8 * chunk) + " ? length" + id +
+                                                   " - " + std::to_string(8 * chunk) + " : 0)";
+            // Bytes past the field belong to the next fields, or to the zeroed buffer, and are cleared. An empty last
+            // field of a 16 bytes key starts at 16, so its shift is taken modulo 16 bytes
+            std::string load = "load_field(" + chunkStart + ", " + bytes + ", end)";
+            if(inRegisters){
+                load = "_bzhi_u64((uint64_t)(whole >> (8 * (" + chunkStart + " & 15))), 8 * " + bytes + ")";
+            } else if(buffered){
+                load = "_bzhi_u64(load_u64_le(" + chunkStart + "), 8 * std::min<std::size_t>(" + bytes + ", 8))";
+            }
+            synthesizedHashFunc += "\t\tconst std::size_t hashable" + chunkID + " = _pext_u64(" + load + ", 0x" +
+                                   intToHex(mask) + ")";
+            int bits = classBits * chunkBytes;
+            if(chunk == 0){
+                // The length tells apart fields whose compressed bytes are equal, like "1" and "01"
+                synthesizedHashFunc += " << " + std::to_string(lengthBits) + " | length" + id;
+                bits += lengthBits;
+            }
+            synthesizedHashFunc += ";\n";
+
+            const size_t rotation = usedBits % 64;
+            if(rotation == 0){
+                synthesizedHashFunc += "\t\thash ^= hashable" + chunkID + ";\n";
+            } else {
+                synthesizedHashFunc += "\t\thash ^= hashable" + chunkID + " << " + std::to_string(rotation) +
+                                       " | hashable" + chunkID + " >> " + std::to_string(64 - rotation) + ";\n";
+            }
+            usedBits += bits;
+        }
+    }
+    synthesizedHashFunc += "\t\treturn hash;\n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @struct KeyField
+ * @brief A field of a multi-field key: either a string described by a regex, or a fixed-width unsigned integer.
+ */
+struct KeyField{
+    std::string regex; ///< Regex of a string field. Empty for integer fields.
+    std::string orMask; ///< OR of every position of a string field, as printed by keybuilder. May be empty.
+    std::string andMask; ///< AND of every position of a string field, as printed by keybuilder. May be empty.
+    std::vector<size_t> redundant; ///< Redundant positions of a string field, as printed by keybuilder. May be empty.
+    int intBits = 0; ///< Width in bits of an integer field. Zero for string fields.
+};
+
+/**
+ * @brief Synthesize the struct holding a multi-field key.
+ *
+ * @param fields The fields of the key, in order.
+ * @return std::string The synthesized key struct as a string.
+ */
+std::string synthetizeMultiFieldKey(const std::vector<KeyField>& fields){
+    std::string synthesizedKey = "struct synthesizedKey {\n";
+    for(size_t fieldID = 0; fieldID < fields.size(); fieldID++){
+        const std::string type = fields[fieldID].intBits ? "uint" + std::to_string(fields[fieldID].intBits) + "_t" : "std::string";
+        synthesizedKey += "\t" + type + " field" + std::to_string(fieldID) + ";\n";
+    }
+    synthesizedKey += "\tbool operator==(const synthesizedKey& other) const = default;\n";
+    synthesizedKey += "};\n";
+    return synthesizedKey;
+}
+
+/**
+ * @brief Synthesize a hash function for a multi-field key.
+ *
+ * Instead of hashing every field with a full hash function and combining the results, the loads of every field are
+ * compressed (PEXT) or used as is (OffXor), and all of them go into a single XOR cascade. Integer fields are used as
+ * they are. String fields of at most 8 bytes are hashed with std::hash, since they cannot be loaded as a whole word.
+ * Every load is rotated into the bits right above the previous ones, and the fields after the first one are multiplied
+ * by distinct odd constants, so that swapping two fields of the same regex changes the hash.
+ *
+ * @param fields The fields of the key, in order.
+ * @param pext Whether to compress the loads with PEXT, otherwise the OffXor function is synthesized.
+ * @return std::string The synthesized multi-field hash function as a string.
+ */
+std::string synthetizeMultiFieldHashFunc(const std::vector<KeyField>& fields, bool pext){
+
+    std::string synthesizedHashFunc = std::string("struct ") +
+        (pext ? "synthesizedMultiFieldPextHash" : "synthesizedMultiFieldOffXorHash") +
+        " {\n\tstd::size_t operator()(const synthesizedKey& key) const {\n";
+
+    std::string masksStr;
+    std::string hashablesStr;
+    std::vector<int> usedBits;
+    std::vector<std::vector<size_t>> fieldHashables(fields.size());
+    for(size_t fieldID = 0; fieldID < fields.size(); fieldID++){
+        const std::string field = "key.field" + std::to_string(fieldID);
+        std::string hashable = "\t\tconst std::size_t hashable" + std::to_string(usedBits.size()) + " = ";
+
+        if(fields[fieldID].intBits){
+            hashablesStr += hashable + field + ";\n";
+            fieldHashables[fieldID].push_back(usedBits.size());
+            usedBits.push_back(fields[fieldID].intBits);
+            continue;
+        }
+
+        std::string regex = fields[fieldID].regex;
+        std::pair<std::vector<Range>,size_t> res = calculateKeyRanges(regex, fields[fieldID].orMask, fields[fieldID].andMask);
+        std::vector<Range> ranges = fields[fieldID].redundant.empty() ? res.first
+                                                                      : dropRedundantPositions(res.first, fields[fieldID].redundant);
+        size_t offset = res.second;
+
+        if(ranges.size() == 0){
+            hashablesStr += "\t\t// " + field + " is constant, so it is not hashed\n";
+            continue;
+        }
+
+        size_t keySize = ranges[ranges.size() - 1].offset + ranges[ranges.size() - 1].repetition;
+        if(keySize <= 8){
+            hashablesStr += hashable + "std::hash<std::string>{}(" + field + ");\n";
+            fieldHashables[fieldID].push_back(usedBits.size());
+            usedBits.push_back(64);
+            continue;
+        }
+
+        for(const auto& load : calculatePextLayout(ranges, offset)){
+            hashable = "\t\tconst std::size_t hashable" + std::to_string(usedBits.size()) + " = ";
+            const std::string loadStr = "load_u64_le(" + field + ".c_str()+" + std::to_string(load.offset) + ")";
+            fieldHashables[fieldID].push_back(usedBits.size());
+            if(pext){
+                const std::string maskID = "mask" + std::to_string(usedBits.size());
+                masksStr += "\t\tconstexpr std::size_t " + maskID + " = 0x" + load.mask + ";\n";
+                hashablesStr += hashable + "_pext_u64(" + loadStr + ", " + maskID + ");\n";
+                usedBits.push_back(64 - countZeros(std::stoull(load.mask, nullptr, 16)));
+            } else {
+                hashablesStr += hashable + loadStr + ";\n";
+                usedBits.push_back(64);
+            }
+        }
+    }
+
+    if(usedBits.empty()){
+        hashablesStr += "\t\tconst std::size_t hashable0 = 0;\n";
+        fieldHashables[0].push_back(0);
+        usedBits.push_back(64);
+    }
+
+    synthesizedHashFunc += masksStr + hashablesStr;
+
+    // Rotate every hashable into the next free bits, across fields, so that no two fields share their shifts
+    int rotation = 0;
+    for(size_t i = 0; i < usedBits.size(); i++){
+        const std::string id = std::to_string(i);
+        if(rotation == 0){
+            synthesizedHashFunc += "\t\tsize_t shift" + id + " = hashable" + id + ";\n";
+        } else {
+            synthesizedHashFunc += "\t\tsize_t shift" + id + " = hashable" + id + " << " + std::to_string(rotation) +
+                                   " | hashable" + id + " >> " + std::to_string(64 - rotation) + ";\n";
+        }
+        rotation = (rotation + usedBits[i]) % 64;
+    }
+
+    // Full-width loads rotate back to the same bits, so the fields after the first one are also multiplied by their own
+    // odd constant. Otherwise fields with the same regex cancel each other, and swapping them keeps the hash
+    std::queue<std::string> queue;
+    for(size_t fieldID = 0; fieldID < fields.size(); fieldID++){
+        const std::vector<size_t>& ids = fieldHashables[fieldID];
+        if(ids.empty()){
+            continue;
+        }
+        std::string partial = "shift" + std::to_string(ids[0]);
+        for(size_t i = 1; i < ids.size(); i++){
+            partial += " ^ shift" + std::to_string(ids[i]);
+        }
+        if(!queue.empty()){
+            const std::size_t multiplier = 0x9e3779b97f4a7c15ULL * (2 * queue.size() - 1);
+            partial = (ids.size() > 1 ? "(" + partial + ")" : partial) + " * 0x" + intToHex(multiplier);
+        }
+        const std::string partialID = "partial" + std::to_string(fieldID);
+        synthesizedHashFunc += "\t\tsize_t " + partialID + " = " + partial + ";\n";
+        queue.push(partialID);
+    }
+
+    // Cascade XOR variables
+    synthesizedHashFunc += cascadeXorVars(queue);
+
+    synthesizedHashFunc += "\t\treturn " + queue.front() + "; \n";
+    synthesizedHashFunc += "\t}\n};\n";
+
+    return synthesizedHashFunc;
+}
+
+/**
+ * @brief Struct to hold the command line parameters of keysynth.
+ */
+struct SynthParameters{
+    std::string regex; ///< Regex of the keys, generated by keybuilder.
+    std::string binaryMask; ///< Mask of the varying bits of binary keys, generated by `keybuilder --binary`.
+    std::string orMask; ///< OR of every position of the keys, generated by keybuilder. May be empty.
+    std::string andMask; ///< AND of every position of the keys, generated by keybuilder. May be empty.
+    std::vector<double> entropy; ///< Entropy of every position of the keys, generated by keybuilder. May be empty.
+    bool lookup = false; ///< Also print the table-lookup hash function.
+    bool lookup16 = false; ///< Also print the table-lookup hash function with uint16_t tables.
+    std::string mphKeysFile; ///< Print a minimal perfect hash function of the keys in this file instead. May be empty.
+    bool layout = false; ///< Print the PEXT layout table instead of the synthesized functions.
+    bool sortKey = false; ///< Print the order-preserving sort key extractor instead of the synthesized functions.
+    bool partition = false; ///< Also print the partition function.
+    size_t familySize = 0; ///< Also print a family of this many independent hash functions. Zero disables it.
+    size_t padding = 0; ///< Readable bytes after every key, for the padded hash functions. Zero disables them.
+    bool caseInsensitive = false; ///< Print the case-insensitive hash function and equality instead.
+    bool embedded = false; ///< Also print the hash functions of fields embedded in larger records.
+    bool guarded = false; ///< The layout ignores outliers, so also print a hash function that checks keys conform to it.
+    std::vector<size_t> redundant; ///< Positions determined by the other ones, printed by keybuilder. May be empty.
+    std::vector<double> velocity; ///< How often every position changes between consecutive keys, printed by keybuilder. May be empty.
+    std::vector<KeyField> fields; ///< Fields of a multi-field key. Empty for single string keys.
+    std::string delimiters = ".:-/"; ///< Characters that split the fields of a tokenized regex, printed by keybuilder.
+};
+
+static std::string correctSynthUsage(){
+    return "Correct Usage: ./keysynth [options] <regex>\n"
+           "       ./keysynth --fields <field0> <field1> ... <fieldN>\n"
+           "       <regex>: regular expression of the keys, generated by keybuilder\n"
+           "       --binary <mask>: synthesize for fixed size binary keys, with the mask generated by keybuilder --binary\n"
+           "       --or-mask <mask> --and-mask <mask>: bits observed by keybuilder in every position, used for tighter masks\n"
+           "       --layout: print the PEXT layout table read by keyuser's RuntimePext hashes instead of C++ code\n"
+           "       --entropy <e0,e1,...,eN>: entropy of every position, printed by keybuilder\n"
+           "       --velocity <v0,v1,...,vN>: how often every position changes between consecutive keys, printed by\n"
+           "               keybuilder for sequential keys. Also print a Pext hash function with the fastest positions in\n"
+           "               the lowest bits\n"
+           "       --lookup: also print a table-lookup hash function over the highest entropy positions\n"
+           "       --lookup16: also print the table-lookup hash function with tables of uint16_t, half as large\n"
+           "       --family <k>: also print a family of k (2 to 64) independent hash functions over the same loads, e.g. for cuckoo tables\n"
+           "       --partition: also print a partition<k>() function, which splits the keys into 2^k partitions\n"
+           "       --embedded: also print hash_at() and hash_field() functions, which hash the key as a field of a larger\n"
+           "               record, such as a CSV row, without copying it\n"
+           "       --guarded: the masks ignore outliers, printed by keybuilder --outliers, so also print a Pext hash\n"
+           "               function that checks the keys conform to them, and falls back to std::hash otherwise\n"
+           "       --redundant <p0,p1,...,pN>: positions determined by the other ones, such as check digits, printed by\n"
+           "               keybuilder --redundant. The hash functions do not load them\n"
+           "       --mph <keys file>: print a minimal perfect hash function of the keys in the file, one per line,\n"
+           "               whose first level is the PEXT hash function, instead of the hash functions\n"
+           "       --padded <N>: keys are followed by at least N readable bytes, 16 to 4096, so the Pext, OffXor, and Aes\n"
+           "               functions load them with a fixed stride and mask off the tail, instead of moving the last load back\n"
+           "       --case-insensitive: print a Pext hash function that ignores the case of letters, and a matching SIMD\n"
+           "               equality comparator, instead of the hash functions\n"
+           "       --delimiters <chars>: characters that split the fields of a regex with {m,n} lengths, printed by\n"
+           "               keybuilder --tokenize. Such regexes get a delimiter-anchored hash function. Defaults to .:-/\n"
+           "       --sort-key: print an order-preserving sort key extractor, for radix sorting, instead of the hash functions\n"
+           "       --fields <field0> <field1> ... <fieldN>: synthesize one hash for a struct of fields, instead of a single key.\n"
+           "               Each field is either a string regex generated by keybuilder, or one of u8, u16, u32, u64.\n"
+           "               The --or-mask, --and-mask, and --redundant options after a string field apply to it\n"
+           "       -h or --help: print this message\n"
+           ;
+}
+
+/**
+ * @brief Split the command line arguments into the options printed by keybuilder.
+ *
+ * keybuilder prints the regex in its first line, and any other options it infers in the following lines, so its output
+ * may be passed to keysynth as a single quoted argument. Lines starting with "--" are split on whitespace, and other
+ * lines are kept as they are, since a regex may contain whitespace.
+ *
+ * @param argc The count of command line arguments.
+ * @param argv An array of command line arguments.
+ * @return std::vector<std::string> The expanded arguments, without the program name.
+ */
+static std::vector<std::string> expandArgs(int argc, char** argv){
+    std::vector<std::string> args;
+    for(int i = 1; i < argc; i++){
+        std::istringstream arg(argv[i]);
+        std::string line;
+        while(std::getline(arg, line)){
+            if(line.rfind("--", 0) != 0){
+                args.push_back(line);
+                continue;
+            }
+            std::istringstream words(line);
+            std::string word;
+            while(words >> word){
+                args.push_back(word);
+            }
+        }
+    }
+    return args;
+}
+
+// Whether a string is a hexadecimal mask with two digits per byte
+static bool isHexMask(const std::string& mask){
+    return mask.size() % 2 == 0 && mask.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos;
+}
+
+static SynthParameters parseArgs(int argc, char** argv){
+    SynthParameters args;
+    std::vector<std::string> argList = expandArgs(argc, argv);
+    for(size_t i = 0; i < argList.size(); i++){
+        const char* arg = argList[i].c_str();
+        if(strcmp(arg, "--layout") == 0){
+            args.layout = true;
+        }else if(strcmp(arg, "--family") == 0 && i + 1 < argList.size()){
+            // atoi would turn "-1" into a huge size_t, so only short runs of digits are accepted
+            const std::string& value = argList[++i];
+            const bool digits = !value.empty() && value.size() <= 3 && value.find_first_not_of("0123456789") == std::string::npos;
+            args.familySize = digits ? std::stoul(value) : 0;
+            if(args.familySize < 2 || args.familySize > FAMILY_MAX_SIZE){
+                fprintf(stderr, "Invalid family size: %s, it must be between 2 and %lu\n", value.c_str(), FAMILY_MAX_SIZE);
+                exit(1);
+            }
+        }else if(strcmp(arg, "--partition") == 0){
+            args.partition = true;
+        }else if(strcmp(arg, "--mph") == 0 && i + 1 < argList.size()){
+            args.mphKeysFile = argList[++i];
+        }else if(strcmp(arg, "--padded") == 0 && i + 1 < argList.size()){
+            // atoi would turn "-5" into a huge size_t, so only short runs of digits are accepted
+            const std::string& value = argList[++i];
+            const bool digits = !value.empty() && value.size() <= 4 && value.find_first_not_of("0123456789") == std::string::npos;
+            args.padding = digits ? std::stoul(value) : 0;
+            if(args.padding < 16 || args.padding > PADDING_MAX_SIZE){
+                fprintf(stderr, "Invalid padding: %s, it must be between 16 (the Aes function loads 16 bytes at a time) and %lu\n",
+                        value.c_str(), PADDING_MAX_SIZE);
+                exit(1);
+            }
+        }else if(strcmp(arg, "--embedded") == 0){
+            args.embedded = true;
+        }else if(strcmp(arg, "--guarded") == 0){
+            args.guarded = true;
+        }else if(strcmp(arg, "--redundant") == 0 && i + 1 < argList.size()){
+            std::istringstream positions(argList[++i]);
+            std::string position;
+            while(std::getline(positions, position, ',')){
+                args.redundant.push_back(std::stoul(position));
+            }
+        }else if(strcmp(arg, "--case-insensitive") == 0){
+            args.caseInsensitive = true;
+        }else if(strcmp(arg, "--delimiters") == 0 && i + 1 < argList.size()){
+            args.delimiters = argList[++i];
+        }else if(strcmp(arg, "--sort-key") == 0){
+            args.sortKey = true;
+        }else if(strcmp(arg, "--binary") == 0 && i + 1 < argList.size()){
+            args.binaryMask = argList[++i];
+            if(!isHexMask(args.binaryMask)){
+                fprintf(stderr, "Invalid binary mask: %s\n", args.binaryMask.c_str());
+                exit(1);
+            }
+        }else if(strcmp(arg, "--or-mask") == 0 && i + 1 < argList.size()){
+            args.orMask = argList[++i];
+        }else if(strcmp(arg, "--and-mask") == 0 && i + 1 < argList.size()){
+            args.andMask = argList[++i];
+        }else if(strcmp(arg, "--entropy") == 0 && i + 1 < argList.size()){
+            std::istringstream entropies(argList[++i]);
+            std::string entropy;
+            while(std::getline(entropies, entropy, ',')){
+                args.entropy.push_back(atof(entropy.c_str()));
+            }
+        }else if(strcmp(arg, "--velocity") == 0 && i + 1 < argList.size()){
+            std::istringstream velocities(argList[++i]);
+            std::string velocity;
+            while(std::getline(velocities, velocity, ',')){
+                args.velocity.push_back(atof(velocity.c_str()));
+            }
+        }else if(strcmp(arg, "--lookup") == 0){
+            args.lookup = true;
+        }else if(strcmp(arg, "--lookup16") == 0){
+            args.lookup16 = true;
+        }else if(strcmp(arg, "--fields") == 0){
+            for(i++; i < argList.size(); i++){
+                const char* fieldArg = argList[i].c_str();
+                // Observed masks belong to the string field printed right before them
+                if((strcmp(fieldArg, "--or-mask") == 0 || strcmp(fieldArg, "--and-mask") == 0) &&
+                   i + 1 < argList.size() && !args.fields.empty() && !args.fields.back().regex.empty()){
+                    std::string& mask = fieldArg[2] == 'o' ? args.fields.back().orMask : args.fields.back().andMask;
+                    mask = argList[++i];
+                    continue;
+                }
+                if(strcmp(fieldArg, "--redundant") == 0 && i + 1 < argList.size() &&
+                   !args.fields.empty() && !args.fields.back().regex.empty()){
+                    std::istringstream positions(argList[++i]);
+                    std::string position;
+                    while(std::getline(positions, position, ',')){
+                        args.fields.back().redundant.push_back(std::stoul(position));
+                    }
+                    continue;
+                }
+                // Multi-field hash functions do not check that keys conform to the masks
+                if(strcmp(fieldArg, "--guarded") == 0){
+                    fprintf(stderr, "--guarded is not supported by --fields, run keybuilder without --outliers for field %s\n",
+                            args.fields.empty() ? "" : args.fields.back().regex.c_str());
+                    exit(1);
+                }
+                // Other annotations of a field are not used by multi-field hash functions
+                if((strcmp(fieldArg, "--entropy") == 0 || strcmp(fieldArg, "--velocity") == 0) && i + 1 < argList.size()){
+                    i++;
+                    continue;
+                }
+                if(strncmp(fieldArg, "--", 2) == 0){
+                    fprintf(stderr, "Invalid argument of a field: %s\n", fieldArg);
+                    exit(1);
+                }
+                KeyField field;
+                if(strcmp(fieldArg, "u8") == 0 || strcmp(fieldArg, "u16") == 0 ||
+                   strcmp(fieldArg, "u32") == 0 || strcmp(fieldArg, "u64") == 0){
+                    field.intBits = atoi(fieldArg + 1);
+                } else {
+                    field.regex = fieldArg;
+                }
+                args.fields.push_back(field);
+            }
+        }else if(strcmp(arg, "-h") == 0 ||
+                 strcmp(arg, "--help") == 0){
+            fprintf(stderr, "%s", correctSynthUsage().c_str());
+            exit(0);
+        }else if(args.regex.empty()){
+            args.regex = arg;
+        }else{
+            fprintf(stderr, "Invalid argument: %s\n", arg);
+            fprintf(stderr, "%s", correctSynthUsage().c_str());
+            exit(1);
+        }
+    }
+    if(!isHexMask(args.orMask) || !isHexMask(args.andMask) || args.orMask.size() != args.andMask.size()){
+        fprintf(stderr, "Invalid observed masks: --or-mask %s --and-mask %s\n", args.orMask.c_str(), args.andMask.c_str());
+        exit(1);
+    }
+    for(const auto& field : args.fields){
+        if(!isHexMask(field.orMask) || !isHexMask(field.andMask) || field.orMask.size() != field.andMask.size()){
+            fprintf(stderr, "Invalid observed masks of field %s\n", field.regex.c_str());
+            exit(1);
+        }
+    }
+    if(args.layout + args.sortKey + !args.mphKeysFile.empty() + args.caseInsensitive + (args.padding > 0) > 1){
+        fprintf(stderr, "Only one of --layout, --sort-key, --mph, --case-insensitive, and --padded may be used.\n");
+        exit(1);
+    }
+    if(args.guarded && args.orMask.empty()){
+        fprintf(stderr, "--guarded needs the --or-mask and --and-mask printed by keybuilder.\n");
+        exit(1);
+    }
+    if(!args.regex.empty() + !args.binaryMask.empty() + !args.fields.empty() != 1){
+        fprintf(stderr, "Expected either a regex, a binary mask, or a list of fields.\n");
+        fprintf(stderr, "%s", correctSynthUsage().c_str());
+        exit(1);
+    }
+    return args;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * This is the main function of the program. It processes command line arguments, which are expected to be a regular expression representing the key format.
+ * The regular expression should be generated by the keybuilder component of this project.
+ * The function then initiates the appropriate processes based on the provided arguments.
+ *
+ * @param argc The count of command line arguments.
+ * @param argv An array of command line arguments.
+ * @return int Returns zero upon successful program execution, non-zero values indicate an error.
+ */
+int main(int argc, char** argv){
+
+    SynthParameters args = parseArgs(argc, argv);
+
+    if(!args.fields.empty()){
+        printf("// Helper function, include in your codebase:\n");
+        printf("%s\n", load_u64_le.c_str());
+        printf("// Multi-field key, rename the fields as in your codebase:\n");
+        printf("%s\n", synthetizeMultiFieldKey(args.fields).c_str());
+        printf("// Multi-field Pext Hash Function:\n");
+        printf("%s\n", synthetizeMultiFieldHashFunc(args.fields, true).c_str());
+        printf("// Multi-field OffXor Hash Function:\n");
+        printf("%s", synthetizeMultiFieldHashFunc(args.fields, false).c_str());
+        return 0;
+    }
+
+    std::string regexStr = args.regex;
+
+    if(!regexStr.empty() && isTokenizedRegex(regexStr)){
+        if(args.layout || args.sortKey || !args.mphKeysFile.empty() || args.caseInsensitive || args.padding){
+            fprintf(stderr, "Fields of variable length only have the delimiter-anchored hash function.\n");
+            return 1;
+        }
+        std::string fieldDelimiters;
+        std::vector<TokenField> fields = calculateTokenFields(regexStr, args.delimiters, fieldDelimiters);
+        printf("// Helper function, include in your codebase:\n");
+        printf("%s\n", load_u64_le.c_str());
+        printf("// Delimiter-anchored Pext Hash Function, include <cstring> and <immintrin.h>:\n");
+        printf("%s", synthetizeTokenizedHashFunc(fields, fieldDelimiters).c_str());
+        return 0;
+    }
+
+    // Create ranges
     size_t offset;
     std::vector<Range> ranges;
-    std::pair<std::vector<Range>,size_t> res = calculateRanges(regexStr);
-    ranges = res.first;
+    std::pair<std::vector<Range>,size_t> res = args.binaryMask.empty() ? calculateKeyRanges(regexStr, args.orMask, args.andMask)
+                                                                      : calculateBinaryRanges(args.binaryMask);
+    ranges = args.redundant.empty() ? res.first : dropRedundantPositions(res.first, args.redundant);
     offset = res.second;
 
-    size_t keySize = ranges[ranges.size() - 1].offset + ranges[ranges.size() - 1].repetition;
+    if(ranges.size() == 0){
+        std::cout << "// No regex ranges in the key. Using default Function. \n\
+            struct synthesizedHashFunc{\n\
+                std::size_t operator()(const std::string& key) const {\n\
+                    \treturn std::hash<std::string>{}(key);\n\
+                }\n\
+            }\n";
+        return 0;
+    }
+
+    // Binary keys are always loaded as whole records, even if their last bytes never change
+    size_t keySize = args.binaryMask.empty() ? ranges[ranges.size() - 1].offset + ranges[ranges.size() - 1].repetition
+                                             : offset;
+
+    if(args.layout){
+        if(keySize <= 8){
+            fprintf(stderr, "Key size is less than 8 bytes, there is no PEXT layout to synthesize.\n");
+            return 1;
+        }
+        printf("%s", synthetizePextLayout(ranges, offset).c_str());
+        return 0;
+    }
+
+    if(!args.mphKeysFile.empty()){
+        if(keySize <= 8){
+            fprintf(stderr, "Key size is less than 8 bytes, use the keys as integers instead.\n");
+            return 1;
+        }
+        std::ifstream keysFile(args.mphKeysFile);
+        if(!keysFile){
+            fprintf(stderr, "Could not open keys file: %s\n", args.mphKeysFile.c_str());
+            return 1;
+        }
+        std::vector<std::string> keys;
+        std::string key;
+        while(std::getline(keysFile, key)){
+            keys.push_back(key);
+        }
+        std::string mph = synthetizeMinimalPerfectHashFunc(ranges, offset, keys);
+        if(mph.empty()){
+            return 1;
+        }
+        printf("// Helper function, include in your codebase:\n");
+        printf("%s\n", load_u64_le.c_str());
+        printf("// First level, 'NO SKIP TABLE' Pext Hash Function:\n");
+        printf("%s\n", synthetizePextHashFunc(ranges, offset).c_str());
+        printf("%s", mph.c_str());
+        return 0;
+    }
+
+    if(args.sortKey){
+        if(keySize <= 8){
+            fprintf(stderr, "Key size is less than 8 bytes, compare the keys as integers instead.\n");
+            return 1;
+        }
+        std::string sortKey = synthetizeSortKeyFunc(ranges, offset);
+        if(sortKey.empty()){
+            fprintf(stderr, "The keys have more than 128 variable bits, there is no integer sort key to synthesize.\n");
+            return 1;
+        }
+        printf("// Helper function, include in your codebase:\n");
+        printf("%s\n", load_u64_le.c_str());
+        printf("%s", sortKey.c_str());
+        return 0;
+    }
+
+    if(args.caseInsensitive){
+        if(args.regex.empty()){
+            fprintf(stderr, "Binary keys have no letters, --case-insensitive needs a regex.\n");
+            return 1;
+        }
+        if(keySize <= 8){
+            fprintf(stderr, "Key size is less than 8 bytes, lowercase the keys as integers instead.\n");
+            return 1;
+        }
+        foldCaseRanges(ranges, regexStr);
+        printf("// Helper function, include in your codebase:\n");
+        printf("%s\n", load_u64_le.c_str());
+        printf("// Case-insensitive 'NO SKIP TABLE' Pext Hash Function:\n");
+        printf("%s\n", synthetizePextHashFunc(ranges, offset).c_str());
+        printf("// Case-insensitive Equality, use it with the hash function above, include <algorithm> and <immintrin.h>:\n");
+        printf("%s", synthetizeCaseInsensitiveEqualFunc(offset).c_str());
+        return 0;
+    }
+
+    if(args.padding){
+        printf("// Helper function, include in your codebase:\n");
+        printf("%s\n", load_u64_le.c_str());
+
+        printf("// Padded 'NO SKIP TABLE' Pext Hash Function:\n");
+        printf("%s\n", synthetizePextHashFunc(ranges, offset, args.padding).c_str());
+
+        printf("// Padded OffXor Hash Function:\n");
+        printf("%s\n", synthetizeOffXorHashFunc(ranges, offset, args.padding).c_str());
+
+        printf("// Padded Aes Hash Function:\n");
+        printf("%s", synthetizeAesHashFunc(ranges, offset, args.padding).c_str());
+        return 0;
+    }
 
     if(keySize <= 8){
         printf("// Key size is less than 8 bytes. Using default Function. \n\
@@ -773,12 +2698,40 @@ int main(int argc, char** argv){
 
     printf("// (Recommended) 'NO SKIP TABLE' Pext Hash Function:\n");
     printf("%s\n", synthetizePextHashFunc(ranges, offset).c_str());
+    if(args.guarded){
+        printf("// (Recommended for guarded layouts) Guarded Pext Hash Function, use it instead of the one above:\n");
+        printf("%s\n", synthetizeGuardedHashFunc(args.orMask, args.andMask).c_str());
+    }
+    if(!args.velocity.empty()){
+        printf("// (Recommended for sequential keys) Velocity Pext Hash Function, fastest positions in the lowest bits:\n");
+        printf("%s\n", synthetizeVelocityPextHashFunc(ranges, offset, args.velocity).c_str());
+    }
 
     printf("//  Pext Hash Function:\n");
     printf("%s\n", skipTable_synthetizePextHashFunc(ranges, offset).c_str());
 
     printf("// OffXor Hash Function:\n");
     printf("%s\n", synthetizeOffXorHashFunc(ranges, offset).c_str());
+    if(args.lookup){
+        printf("// Table-lookup Hash Function:\n");
+        printf("%s\n", synthetizeLookupHashFunc(ranges, offset, args.entropy).c_str());
+    }
+    if(args.lookup16){
+        printf("// Table-lookup Hash Function, with tables of uint16_t:\n");
+        printf("%s\n", synthetizeLookupHashFunc(ranges, offset, args.entropy, 16).c_str());
+    }
+    if(args.familySize){
+        printf("// Family of %lu Independent Hash Functions, include <array>:\n", args.familySize);
+        printf("%s\n", synthetizeFamilyHashFunc(ranges, offset, args.familySize).c_str());
+    }
+    if(args.partition){
+        printf("// Partition Function, use the Pext Hash Function inside each partition:\n");
+        printf("%s\n", synthetizePartitionFunc(ranges, offset, args.entropy).c_str());
+    }
+    if(args.embedded){
+        printf("// Embedded Field Pext Hash Functions, include <immintrin.h>:\n");
+        printf("%s\n", synthetizeEmbeddedHashFunc(ranges, offset).c_str());
+    }
     if(keySize > 16){
         printf("// Aes Hash Function:\n");
         printf("%s", synthetizeAesHashFunc(ranges, offset).c_str());
@@ -0,0 +1,65 @@
+/**
+ * @file abslAdapters.hpp
+ * @brief This file contains adapters that feed the synthesized hash functions into Abseil's hashing framework.
+ *
+ * Abseil's Swiss tables use the hash of a custom hasher as is. The 7 lowest bits become the H2 tag that is compared
+ * with 16 slots at a time, and the other bits pick the group where probing starts. Synthesized hash functions often
+ * leave their lowest bits constant, so they may also be fed through AbslHashValue instead, which mixes them like any
+ * other value hashed by absl::Hash.
+ */
+
+#ifndef ABSL_ADAPTERS_HPP
+#define ABSL_ADAPTERS_HPP
+
+#include <string>
+#include <utility>
+
+#include "absl/hash/hash.h"
+
+/**
+ * @brief The synthesized hash of a key, hashed by absl::Hash through AbslHashValue.
+ *
+ * Keys of user-defined types feed synthesized hashes into Abseil the same way, with their own AbslHashValue.
+ *
+ * @tparam HashFuncT The type of the synthesized hash function.
+ */
+template <typename HashFuncT>
+struct SynthesizedHashValue{
+    const std::string& key; ///< The key to hash.
+    const HashFuncT& hash; ///< The synthesized hash function object.
+
+    /**
+     * @brief Combine the synthesized hash of the key into Abseil's hash state.
+     *
+     * @tparam H The type of Abseil's hash state.
+     * @param state The hash state.
+     * @param value The key to hash.
+     * @return H The hash state, combined with the synthesized hash.
+     */
+    template <typename H>
+    friend H AbslHashValue(H state, const SynthesizedHashValue& value){
+        return H::combine(std::move(state), value.hash(value.key));
+    }
+};
+
+/**
+ * @brief Hash function that mixes a synthesized hash function with absl::Hash, through AbslHashValue.
+ *
+ * @tparam HashFuncT The type of the synthesized hash function.
+ */
+template <typename HashFuncT>
+struct AbslMixedHash{
+    HashFuncT hash; ///< The synthesized hash function object.
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key The std::string key to hash.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key) const {
+        return absl::Hash<SynthesizedHashValue<HashFuncT>>{}(SynthesizedHashValue<HashFuncT>{key, hash});
+    }
+};
+
+#endif
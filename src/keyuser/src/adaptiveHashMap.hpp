@@ -0,0 +1,164 @@
+/**
+ * @file adaptiveHashMap.hpp
+ * @brief This file contains a hash map that synthesizes its own hash function from the first keys inserted into it.
+ */
+
+#ifndef ADAPTIVE_HASH_MAP_HPP
+#define ADAPTIVE_HASH_MAP_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "runtimeHashes.hpp"
+
+/**
+ * @brief Default number of inserted keys profiled before synthesizing the hash function.
+ */
+constexpr std::size_t ADAPTIVE_WARMUP_KEYS = 1000;
+
+/**
+ * @brief An std::unordered_map wrapper that profiles its keys and then switches to a synthesized hash function.
+ *
+ * During the warm-up window, keys are hashed by the general hash function (HashFuncT without a layout) and copied to a
+ * sample. When the window is full, a Pext layout is inferred from the sample and the map is rehashed once into the
+ * synthesized hash function. The layout is only adopted if it collides on at most 1% of the sampled keys; otherwise, or
+ * if the keys do not fit a layout, the map keeps the general hash function. Once adopted, every key is still checked
+ * against the bits that were fixed in the sample, and the ones that differ there are hashed by the general function.
+ *
+ * @tparam ValueT The type of the mapped values.
+ * @tparam HashFuncT The hash function type. Must be default constructible into a general hash function, and
+ *                   constructible from a PextLayout into the synthesized one.
+ */
+template <typename ValueT, typename HashFuncT = AdaptivePextHash>
+class AdaptiveHashMap{
+    std::unordered_map<std::string, ValueT, HashFuncT> map; ///< The underlying unordered map.
+    std::vector<std::string> warmupKeys; ///< Keys inserted during the warm-up window.
+    std::size_t warmupSize; ///< Number of keys in the warm-up window.
+    bool adapted = false; ///< Whether the warm-up window is over.
+    bool synthesized = false; ///< Whether the map is using the synthesized hash function.
+
+    /**
+     * @brief Records a key inserted during the warm-up window, synthesizing the hash function when it is full.
+     *
+     * @param key The inserted key.
+     */
+    void observe(const std::string& key){
+        if(adapted){
+            return;
+        }
+        warmupKeys.push_back(key);
+        if(warmupKeys.size() >= warmupSize){
+            adapt();
+        }
+    }
+
+    /**
+     * @brief Synthesizes the hash function from the warm-up keys and rehashes the map into it.
+     */
+    void adapt(){
+        adapted = true;
+
+        PextLayout layout;
+        if(inferPextLayout(warmupKeys, layout)){
+            HashFuncT candidate(layout);
+
+            // Conformance check: the synthesized hash must tell apart the sampled keys
+            std::sort(warmupKeys.begin(), warmupKeys.end());
+            warmupKeys.erase(std::unique(warmupKeys.begin(), warmupKeys.end()), warmupKeys.end());
+            std::vector<std::size_t> hashes;
+            hashes.reserve(warmupKeys.size());
+            for(const auto& key : warmupKeys){
+                hashes.push_back(candidate(key));
+            }
+            std::sort(hashes.begin(), hashes.end());
+            const std::size_t distinct = std::unique(hashes.begin(), hashes.end()) - hashes.begin();
+
+            if(distinct * 100 >= warmupKeys.size() * 99){
+                std::unordered_map<std::string, ValueT, HashFuncT> rehashed(map.bucket_count(), candidate);
+                rehashed.insert(std::make_move_iterator(map.begin()), std::make_move_iterator(map.end()));
+                map.swap(rehashed);
+                synthesized = true;
+            }
+        }
+
+        warmupKeys.clear();
+        warmupKeys.shrink_to_fit();
+    }
+
+    public:
+        using iterator = typename std::unordered_map<std::string, ValueT, HashFuncT>::iterator;
+
+        /**
+         * @brief Construct a new Adaptive Hash Map object.
+         *
+         * @param _warmupSize Number of inserted keys profiled before synthesizing the hash function.
+         */
+        explicit AdaptiveHashMap(std::size_t _warmupSize = ADAPTIVE_WARMUP_KEYS) :
+            warmupSize(_warmupSize)
+            {
+                warmupKeys.reserve(warmupSize);
+            }
+
+        /**
+         * @brief Access or insert the value mapped to a key.
+         *
+         * @param key The key to access.
+         * @return ValueT& The value mapped to the key.
+         */
+        ValueT& operator[](const std::string& key){
+            // Observe first, the rehash would invalidate the returned reference
+            observe(key);
+            return map[key];
+        }
+
+        /**
+         * @brief Search for a key in the map.
+         *
+         * @param key The key to search for.
+         * @return iterator The iterator to the key, or end() if it is not found.
+         */
+        iterator find(const std::string& key){ return map.find(key); }
+
+        /**
+         * @brief Get the past-the-end iterator of the map.
+         */
+        iterator end(){ return map.end(); }
+
+        /**
+         * @brief Remove a key from the map.
+         *
+         * @param key The key to remove.
+         * @return std::size_t The number of removed elements.
+         */
+        std::size_t erase(const std::string& key){ return map.erase(key); }
+
+        /**
+         * @brief Remove every element and restart the warm-up window with the general hash function.
+         */
+        void clear(){
+            map = std::unordered_map<std::string, ValueT, HashFuncT>();
+            warmupKeys.clear();
+            adapted = false;
+            synthesized = false;
+        }
+
+        /**
+         * @brief Whether the map is using the synthesized hash function.
+         */
+        bool isSynthesized() const { return synthesized; }
+
+        /**
+         * @brief Get the underlying unordered map.
+         */
+        const std::unordered_map<std::string, ValueT, HashFuncT>& container() const { return map; }
+
+        /**
+         * @brief Get the hash function currently used by the map.
+         */
+        HashFuncT hash_function() const { return map.hash_function(); }
+};
+
+#endif
@@ -11,6 +11,12 @@
 #include <chrono>
 #include <algorithm>
 #include <random>
+#include <thread>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 void executeInterweaved(Benchmark* bench, 
                         const std::vector<std::string>& keys, 
@@ -275,6 +281,376 @@ void testHashPerformance(const std::vector<Benchmark*>& benchmarks,
     }
 }
 
+// LSD radix sort of (sort key, index) pairs, one byte per pass, up to the number of bits of the sort key
+template <typename SortKeyT>
+static void radixSort(std::vector<std::pair<SortKeyT, uint32_t>>& items, unsigned bits){
+    std::vector<std::pair<SortKeyT, uint32_t>> buffer(items.size());
+    for(unsigned shift = 0; shift < bits && !items.empty(); shift += 8){
+        std::size_t counts[256] = {0};
+        for(const auto& item : items){
+            counts[(item.first >> shift) & 0xff]++;
+        }
+        // Skip the byte if every key has the same value in it
+        if(counts[(items.front().first >> shift) & 0xff] == items.size()){
+            continue;
+        }
+        std::size_t position = 0;
+        for(auto& count : counts){
+            const std::size_t bucketSize = count;
+            count = position;
+            position += bucketSize;
+        }
+        for(const auto& item : items){
+            buffer[counts[(item.first >> shift) & 0xff]++] = item;
+        }
+        items.swap(buffer);
+    }
+}
+
+template <typename SortKeyT>
+static std::vector<std::string> radixSortKeys(const std::vector<std::string>& keys, const RuntimeSortKey& sortKey){
+    std::vector<std::pair<SortKeyT, uint32_t>> items(keys.size());
+    for(std::size_t i = 0; i < keys.size(); i++){
+        items[i] = {(SortKeyT)sortKey(keys[i]), (uint32_t)i};
+    }
+    radixSort(items, sortKey.bits);
+
+    std::vector<std::string> sorted;
+    sorted.reserve(keys.size());
+    for(const auto& item : items){
+        sorted.push_back(keys[item.second]);
+    }
+    return sorted;
+}
+
+void testSortPerformance(const std::vector<std::string>& keys,
+                         const RuntimeSortKey& sortKey,
+                         const BenchmarkParameters& args){
+
+    printf("Sort Method,Elapsed Time (seconds)\n");
+    for(int r=0; r < args.repetitions; ++r){
+        std::vector<std::string> expected = keys;
+        auto start = std::chrono::system_clock::now();
+        std::sort(expected.begin(), expected.end());
+        auto end = std::chrono::system_clock::now();
+        std::chrono::duration<double> elapsed_seconds = end-start;
+        printf("%s,%f\n", "std::sort", elapsed_seconds.count());
+
+        start = std::chrono::system_clock::now();
+        std::vector<std::string> sorted = sortKey.bits > 64 ? radixSortKeys<__uint128_t>(keys, sortKey)
+                                                            : radixSortKeys<uint64_t>(keys, sortKey);
+        end = std::chrono::system_clock::now();
+        elapsed_seconds = end-start;
+        printf("%s,%f\n", "RadixSort", elapsed_seconds.count());
+
+        if(sorted != expected){
+            fprintf(stderr, "WARNING: the radix sort order differs from std::sort, the layout does not fit the keys!\n");
+        }
+    }
+}
+
+// Runs func(threadID) in numThreads threads and waits for all of them
+template <typename FuncT>
+static void runThreads(unsigned numThreads, const FuncT& func){
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < numThreads; t++){
+        threads.emplace_back(func, t);
+    }
+    for(auto& thread : threads){
+        thread.join();
+    }
+}
+
+// Partitions the keys' indices with numThreads threads, returning the size of every partition
+template <typename PartitionFuncT>
+static std::vector<std::size_t> radixPartition(const std::vector<std::string>& keys,
+                                               const PartitionFuncT& partitionFunc,
+                                               std::size_t numPartitions,
+                                               unsigned numThreads,
+                                               std::vector<uint32_t>& partitioned){
+    std::vector<uint32_t> partitionIDs(keys.size());
+    std::vector<std::vector<std::size_t>> counts(numThreads, std::vector<std::size_t>(numPartitions, 0));
+    auto sliceBegin = [&](unsigned t){ return keys.size() * t / numThreads; };
+
+    // First pass: every thread counts the partitions of its slice
+    runThreads(numThreads, [&](unsigned t){
+        for(std::size_t i = sliceBegin(t); i < sliceBegin(t+1); i++){
+            partitionIDs[i] = partitionFunc(keys[i]) & (numPartitions - 1);
+            counts[t][partitionIDs[i]]++;
+        }
+    });
+
+    // Every thread writes after the previous partitions, and after the previous threads in its partition
+    std::vector<std::size_t> partitionSizes(numPartitions, 0);
+    std::size_t position = 0;
+    for(std::size_t p = 0; p < numPartitions; p++){
+        for(unsigned t = 0; t < numThreads; t++){
+            const std::size_t count = counts[t][p];
+            counts[t][p] = position;
+            position += count;
+            partitionSizes[p] += count;
+        }
+    }
+
+    // Second pass: every thread scatters its slice
+    runThreads(numThreads, [&](unsigned t){
+        for(std::size_t i = sliceBegin(t); i < sliceBegin(t+1); i++){
+            partitioned[counts[t][partitionIDs[i]]++] = i;
+        }
+    });
+
+    return partitionSizes;
+}
+
+template <typename PartitionFuncT>
+static void reportPartitionPerformance(const char* partitionName,
+                                       const std::vector<std::string>& keys,
+                                       const PartitionFuncT& partitionFunc,
+                                       std::size_t numPartitions,
+                                       unsigned numThreads){
+    std::vector<uint32_t> partitioned(keys.size());
+
+    auto start = std::chrono::system_clock::now();
+    std::vector<std::size_t> partitionSizes = radixPartition(keys, partitionFunc, numPartitions, numThreads, partitioned);
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end-start;
+
+    const double meanSize = (double)keys.size() / numPartitions;
+    const std::size_t maxSize = *std::max_element(partitionSizes.begin(), partitionSizes.end());
+    printf("%s,%u,%lu,%f,%f,%f\n",
+           partitionName,
+           numThreads,
+           numPartitions,
+           elapsed_seconds.count(),
+           keys.size() / elapsed_seconds.count() / numThreads,
+           maxSize / meanSize);
+}
+
+void testPartitionPerformance(const std::vector<std::string>& keys,
+                              const RuntimePartition& partition,
+                              const BenchmarkParameters& args){
+
+    unsigned numThreads = args.threads ? args.threads : std::thread::hardware_concurrency();
+    numThreads = numThreads ? numThreads : 1;
+    const std::size_t numPartitions = 1ul << partition.bits;
+
+    printf("Partition Function,Threads,Partitions,Elapsed Time (seconds),Keys per Second per Thread,Skew (max/mean)\n");
+    for(int r=0; r < args.repetitions; ++r){
+        reportPartitionPerformance("RuntimePartition", keys, partition, numPartitions, numThreads);
+        reportPartitionPerformance("CityHash", keys, CityHash(), numPartitions, numThreads);
+        reportPartitionPerformance("AbseilHash", keys, AbseilHash(), numPartitions, numThreads);
+    }
+}
+
+void testIndependence(const std::vector<std::string>& keys,
+                      const RuntimePextFamily& family,
+                      const BenchmarkParameters& args){
+
+    constexpr std::size_t equalBuckets = 1024;
+    constexpr std::size_t jointBuckets = 64;
+
+    std::unordered_set<std::string> uniqueKeys(keys.begin(), keys.end());
+    std::vector<std::vector<std::size_t>> hashes(args.familySize);
+    for(unsigned i = 0; i < args.familySize; i++){
+        for(const auto& key : uniqueKeys){
+            hashes[i].push_back(family(key, i));
+        }
+    }
+
+    printf("Hash Pair,Same Bucket (observed/expected),Joint Chi-Square/DoF\n");
+    for(unsigned i = 0; i < args.familySize; i++){
+        for(unsigned j = i + 1; j < args.familySize; j++){
+            std::size_t sameBucket = 0;
+            std::vector<std::size_t> joint(jointBuckets * jointBuckets, 0);
+            for(std::size_t k = 0; k < uniqueKeys.size(); k++){
+                sameBucket += hashes[i][k] % equalBuckets == hashes[j][k] % equalBuckets;
+                joint[(hashes[i][k] % jointBuckets) * jointBuckets + hashes[j][k] % jointBuckets]++;
+            }
+
+            const double expectedCell = (double)uniqueKeys.size() / joint.size();
+            double chiSquare = 0;
+            for(const auto& cell : joint){
+                chiSquare += (cell - expectedCell) * (cell - expectedCell) / expectedCell;
+            }
+            printf("%u-%u,%f,%f\n",
+                   i,
+                   j,
+                   (double)sameBucket * equalBuckets / uniqueKeys.size(),
+                   chiSquare / (joint.size() - 1));
+        }
+    }
+}
+
+// Hashes every key of a container and returns the elapsed time, folding the hashes into checksum
+template <typename HashFuncT, typename GetKeyT>
+static double timeHashes(const HashFuncT& hash, std::size_t numKeys, const GetKeyT& getKey, std::size_t& checksum){
+    auto start = std::chrono::system_clock::now();
+    for(std::size_t i = 0; i < numKeys; i++){
+        checksum ^= hash(getKey(i));
+    }
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end-start;
+    return elapsed_seconds.count();
+}
+
+// Calls func(line, lineSize) for every line of a buffer
+template <typename FuncT>
+static void forEachLine(const char* data, std::size_t size, const FuncT& func){
+    const char* end = data + size;
+    while(data < end){
+        const char* newline = (const char*)memchr(data, '\n', end - data);
+        const char* lineEnd = newline ? newline : end;
+        func(data, lineEnd - data);
+        data = lineEnd + 1;
+    }
+}
+
+void testFieldPerformance(const PextLayout& layout, const BenchmarkParameters& args){
+    const int fd = open(args.fieldFile.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if(fd < 0 || fstat(fd, &fileStat) != 0 || fileStat.st_size == 0){
+        fprintf(stderr, "Could not read the file %s\n", args.fieldFile.c_str());
+        if(fd >= 0){
+            close(fd);
+        }
+        return;
+    }
+    void* mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED){
+        fprintf(stderr, "Could not map the file %s\n", args.fieldFile.c_str());
+        return;
+    }
+    const char* data = (const char*)mapped;
+    const std::size_t size = fileStat.st_size;
+    const RuntimePaddedPextHash hash(layout);
+
+    printf("Field Access,Elapsed Time (seconds),Fields Hashed\n");
+    for(int r=0; r < args.repetitions; ++r){
+        std::size_t copiedChecksum = 0;
+        std::size_t copiedFields = 0;
+        auto start = std::chrono::system_clock::now();
+        forEachLine(data, size, [&](const char* line, std::size_t lineSize){
+            std::string_view row(line, lineSize);
+            std::size_t fieldStart = 0;
+            for(unsigned column = 0; column < args.fieldColumn && fieldStart != std::string_view::npos; column++){
+                fieldStart = row.find(args.delimiter, fieldStart);
+                fieldStart = fieldStart == std::string_view::npos ? fieldStart : fieldStart + 1;
+            }
+            if(fieldStart == std::string_view::npos || fieldStart + layout.keySize > lineSize){
+                return;
+            }
+            const std::string field(row.substr(fieldStart, layout.keySize));
+            copiedChecksum ^= hash(field.c_str());
+            copiedFields++;
+        });
+        auto end = std::chrono::system_clock::now();
+        std::chrono::duration<double> elapsed_seconds = end-start;
+        printf("%s,%f,%lu\n", "substr", elapsed_seconds.count(), copiedFields);
+
+        std::size_t inPlaceChecksum = 0;
+        std::size_t inPlaceFields = 0;
+        start = std::chrono::system_clock::now();
+        forEachLine(data, size, [&](const char* line, std::size_t lineSize){
+            const char* field = findField(line, lineSize, args.fieldColumn, args.delimiter);
+            if(field == nullptr || field + layout.keySize > line + lineSize){
+                return;
+            }
+            inPlaceChecksum ^= hash(field);
+            inPlaceFields++;
+        });
+        end = std::chrono::system_clock::now();
+        elapsed_seconds = end-start;
+        printf("%s,%f,%lu\n", "hash_at", elapsed_seconds.count(), inPlaceFields);
+
+        if(copiedChecksum != inPlaceChecksum || copiedFields != inPlaceFields){
+            fprintf(stderr, "WARNING: hashing the fields in place differs from hashing their copies!\n");
+        }
+    }
+    munmap(mapped, size);
+}
+
+void testPaddedPerformance(const std::vector<std::string>& keys,
+                           const PextLayout& layout,
+                           const BenchmarkParameters& args){
+
+    const PaddedKeyArena arena(keys, args.padding);
+    const PextLayout padded = padPextLayout(layout);
+    const RuntimePaddedPextHash clampedHash(layout);
+    const RuntimePaddedPextHash paddedHash(padded);
+    const auto fromString = [&](std::size_t i){ return keys[i].c_str(); };
+    const auto fromArena = [&](std::size_t i){ return arena[i]; };
+
+    printf("Key Storage,Loads,Number of Loads,Elapsed Time (seconds)\n");
+    for(int r=0; r < args.repetitions; ++r){
+        std::size_t checksum = 0;
+        double elapsed = timeHashes(clampedHash, keys.size(), fromString, checksum);
+        printf("%s,%s,%lu,%f\n", "std::string", "Clamped", layout.loads.size(), elapsed);
+        elapsed = timeHashes(clampedHash, arena.size(), fromArena, checksum);
+        printf("%s,%s,%lu,%f\n", "PaddedKeyArena", "Clamped", layout.loads.size(), elapsed);
+        elapsed = timeHashes(paddedHash, arena.size(), fromArena, checksum);
+        printf("%s,%s,%lu,%f\n", "PaddedKeyArena", "Padded", padded.loads.size(), elapsed);
+        if(args.verbose){
+            fprintf(stderr, "Checksum: %lu\n", checksum);
+        }
+    }
+}
+
+void testIndexPerformance(const std::vector<std::pair<std::string, std::string>>& entries,
+                          const std::string& indexFile,
+                          const BenchmarkParameters& args){
+
+    printf("Index,Startup Time (seconds),Lookup Time (seconds),Found Keys\n");
+    for(int r=0; r < args.repetitions; ++r){
+        auto start = std::chrono::system_clock::now();
+        StaticIndex index;
+        if(!index.open(indexFile)){
+            fprintf(stderr, "Invalid index file: %s\n", indexFile.c_str());
+            return;
+        }
+        auto end = std::chrono::system_clock::now();
+        std::chrono::duration<double> startup = end-start;
+
+        std::size_t found = 0;
+        std::size_t valueBytes = 0;
+        start = std::chrono::system_clock::now();
+        for(const auto& entry : entries){
+            std::string_view value;
+            if(index.find(entry.first, value)){
+                found++;
+                valueBytes += value.size();
+            }
+        }
+        end = std::chrono::system_clock::now();
+        std::chrono::duration<double> lookup = end-start;
+        printf("%s,%f,%f,%lu\n", "StaticIndex", startup.count(), lookup.count(), found);
+
+        // The container rebuilt at every process start, the first value of duplicated keys is kept
+        start = std::chrono::system_clock::now();
+        std::unordered_map<std::string, std::string> map;
+        map.insert(entries.begin(), entries.end());
+        end = std::chrono::system_clock::now();
+        startup = end-start;
+
+        found = 0;
+        start = std::chrono::system_clock::now();
+        for(const auto& entry : entries){
+            auto it = map.find(entry.first);
+            if(it != map.end()){
+                found++;
+                valueBytes += it->second.size();
+            }
+        }
+        end = std::chrono::system_clock::now();
+        lookup = end-start;
+        printf("%s,%f,%f,%lu\n", "std::unordered_map", startup.count(), lookup.count(), found);
+
+        if(args.verbose){
+            fprintf(stderr, "Value bytes read: %lu\n", valueBytes);
+        }
+    }
+}
+
 void freeBenchmarks(std::vector<Benchmark*>& benchmarks){
     for(auto bench : benchmarks){
         delete bench;
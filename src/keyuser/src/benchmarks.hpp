@@ -6,10 +6,21 @@
 #ifndef BENCHMARKS_HPP
 #define BENCHMARKS_HPP
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <functional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
+
+#include "adaptiveHashMap.hpp"
+#include "collisionMonitor.hpp"
+#include "keyArena.hpp"
+#include "staticIndex.hpp"
 
 /**
  * @brief Base class for benchmarking.
@@ -43,6 +54,49 @@ class Benchmark{
             return colcount;
         }
 
+        /**
+         * @brief Calculates the number of H2 tag collisions in a given Swiss table.
+         * 
+         * Swiss tables have no buckets: the bits above the lowest 7 pick the group of 16 slots where probing starts,
+         * and the lowest 7 bits are the H2 tag compared with every slot of the group at once. Keys that share both the
+         * group and the tag cost a full key comparison on every lookup. Abseil also mixes a per-table seed into the
+         * group, which is ignored here.
+         * 
+         * @tparam SwissTable The type of the Swiss table.
+         * @param container The Swiss table to calculate collisions for.
+         * @return The number of collisions.
+         */
+        template <typename SwissTable>
+        int internalcalculateCollisionCountTags(const SwissTable& container) {
+            const std::size_t capacity = container.capacity();
+            const auto hash = container.hash_function();
+            std::vector<std::size_t> groupTags;
+            groupTags.reserve(container.size());
+            for (const auto& element : container) {
+                const std::size_t h = hash(extractKey(element));
+                groupTags.push_back(((((h >> 7) & capacity) / 16) << 7) | (h & 0x7f));
+            }
+            std::sort(groupTags.begin(), groupTags.end());
+            return groupTags.size() - (std::unique(groupTags.begin(), groupTags.end()) - groupTags.begin());
+        }
+
+    private:
+
+        /**
+         * @brief Get the key of an element of a set.
+         */
+        static const std::string& extractKey(const std::string& key) {
+            return key;
+        }
+
+        /**
+         * @brief Get the key of an element of a map.
+         */
+        template <typename Value>
+        static const std::string& extractKey(const std::pair<const std::string, Value>& element) {
+            return element.first;
+        }
+
     public:
         /**
          * @brief Construct a new Benchmark object.
@@ -138,6 +192,18 @@ class UnorderedMapBench : public Benchmark{
             Benchmark(_name, _hashName)
             {}
 
+        /**
+         * @brief Construct a new Unordered Map Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        UnorderedMapBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            map(0, _hash)
+            {}
+
         /**
          * @brief Insert a key into the unordered map.
          * 
@@ -212,6 +278,18 @@ class UnorderedMultiMapBench : public Benchmark{
         UnorderedMultiMapBench(std::string _name, std::string _hashName) : 
             Benchmark(_name, _hashName)
             {}
+
+        /**
+         * @brief Construct a new Unordered Multi Map Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        UnorderedMultiMapBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            mmap(0, _hash)
+            {}
             
         /**
          * @brief Insert a key into the unordered multimap.
@@ -288,6 +366,18 @@ class UnorderedSetBench : public Benchmark{
             Benchmark(_name, _hashName)
             {}
 
+        /**
+         * @brief Construct a new Unordered Set Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        UnorderedSetBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            set(0, _hash)
+            {}
+
         /**
          * @brief Insert a key into the unordered set.
          * 
@@ -363,6 +453,18 @@ class UnorderedMultisetBench : public Benchmark{
             Benchmark(_name, _hashName)
             {}
 
+        /**
+         * @brief Construct a new Unordered Multiset Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        UnorderedMultisetBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            mset(0, _hash)
+            {}
+
         /**
          * @brief Insert a key into the unordered multiset.
          * 
@@ -418,6 +520,492 @@ class UnorderedMultisetBench : public Benchmark{
         }
 };
 
+/**
+ * @brief A benchmarking class for Abseil's flat hash map with a custom hash function for std::string.
+ * 
+ * @tparam HashFuncT The type of the hash function.
+ */
+template <typename HashFuncT>
+class FlatHashMapBench : public Benchmark{
+    absl::flat_hash_map<std::string, int, HashFuncT> map; ///< The flat hash map used for benchmarking.
+
+    public:
+        /**
+         * @brief Construct a new Flat Hash Map Bench object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         */
+        FlatHashMapBench(std::string _name, std::string _hashName) : 
+            Benchmark(_name, _hashName)
+            {}
+
+        /**
+         * @brief Construct a new Flat Hash Map Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        FlatHashMapBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            map(0, _hash)
+            {}
+
+        /**
+         * @brief Insert a key into the flat hash map.
+         * 
+         * @param key The key to insert.
+         */
+        void insert(const std::string& key) override {
+            map[key] = 0;
+        }
+
+        /**
+         * @brief Search for a key in the flat hash map.
+         * 
+         * @param key The key to search for.
+         * @return true If the key is found.
+         * @return false Otherwise.
+         */
+        bool search(const std::string& key) override {
+            return map.find(key) != map.end();
+        }
+
+        /**
+         * @brief Remove a key from the flat hash map.
+         * 
+         * @param key The key to remove.
+         */
+        void elimination(const std::string& key) override {
+            map.erase(key);
+        }
+
+        /**
+         * @brief Calculate the number of H2 tag collisions in the flat hash map.
+         * 
+         * @return int The number of tag collisions.
+         */
+        int calculateCollisionCountBuckets(void) override {
+            return internalcalculateCollisionCountTags(map);
+        }
+
+        /**
+         * @brief Clear the container benchmark between executions.
+         */
+        void clearContainer(void) override{
+            map.clear();
+        }
+
+        /**
+         * @brief Get the hash function used by the flat hash map.
+         * 
+         * @return std::function<std::size_t(const std::string&)> The hash function.
+         */
+        std::function<std::size_t(const std::string&)> getHashFunction(void) override {
+            return map.hash_function();
+        }
+};
+
+/**
+ * @brief A benchmarking class for Abseil's flat hash set with a custom hash function for std::string.
+ * 
+ * @tparam HashFuncT The type of the hash function.
+ */
+template <typename HashFuncT>
+class FlatHashSetBench : public Benchmark{
+    absl::flat_hash_set<std::string, HashFuncT> set; ///< The flat hash set used for benchmarking.
+
+    public:
+        /**
+         * @brief Construct a new Flat Hash Set Bench object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         */
+        FlatHashSetBench(std::string _name, std::string _hashName) : 
+            Benchmark(_name, _hashName)
+            {}
+
+        /**
+         * @brief Construct a new Flat Hash Set Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        FlatHashSetBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            set(0, _hash)
+            {}
+
+        /**
+         * @brief Insert a key into the flat hash set.
+         * 
+         * @param key The key to insert.
+         */
+        void insert(const std::string& key) override {
+            set.insert(key);
+        }
+
+        /**
+         * @brief Search for a key in the flat hash set.
+         * 
+         * @param key The key to search for.
+         * @return true If the key is found.
+         * @return false Otherwise.
+         */
+        bool search(const std::string& key) override {
+            return set.find(key) != set.end();
+        }
+
+        /**
+         * @brief Remove a key from the flat hash set.
+         * 
+         * @param key The key to remove.
+         */
+        void elimination(const std::string& key) override {
+            set.erase(key);
+        }
+
+        /**
+         * @brief Calculate the number of H2 tag collisions in the flat hash set.
+         * 
+         * @return int The number of tag collisions.
+         */
+        int calculateCollisionCountBuckets(void) override {
+            return internalcalculateCollisionCountTags(set);
+        }
+
+        /**
+         * @brief Clear the container benchmark between executions.
+         */
+        void clearContainer(void) override{
+            set.clear();
+        }
+
+        /**
+         * @brief Get the hash function used by the flat hash set.
+         * 
+         * @return std::function<std::size_t(const std::string&)> The hash function.
+         */
+        std::function<std::size_t(const std::string&)> getHashFunction(void) override {
+            return set.hash_function();
+        }
+};
+
+/**
+ * @brief A benchmarking class for Abseil's node hash map with a custom hash function for std::string.
+ * 
+ * @tparam HashFuncT The type of the hash function.
+ */
+template <typename HashFuncT>
+class NodeHashMapBench : public Benchmark{
+    absl::node_hash_map<std::string, int, HashFuncT> map; ///< The node hash map used for benchmarking.
+
+    public:
+        /**
+         * @brief Construct a new Node Hash Map Bench object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         */
+        NodeHashMapBench(std::string _name, std::string _hashName) : 
+            Benchmark(_name, _hashName)
+            {}
+
+        /**
+         * @brief Construct a new Node Hash Map Bench object with a given hash function object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         * @param _hash The hash function object used by the container.
+         */
+        NodeHashMapBench(std::string _name, std::string _hashName, const HashFuncT& _hash) : 
+            Benchmark(_name, _hashName),
+            map(0, _hash)
+            {}
+
+        /**
+         * @brief Insert a key into the node hash map.
+         * 
+         * @param key The key to insert.
+         */
+        void insert(const std::string& key) override {
+            map[key] = 0;
+        }
+
+        /**
+         * @brief Search for a key in the node hash map.
+         * 
+         * @param key The key to search for.
+         * @return true If the key is found.
+         * @return false Otherwise.
+         */
+        bool search(const std::string& key) override {
+            return map.find(key) != map.end();
+        }
+
+        /**
+         * @brief Remove a key from the node hash map.
+         * 
+         * @param key The key to remove.
+         */
+        void elimination(const std::string& key) override {
+            map.erase(key);
+        }
+
+        /**
+         * @brief Calculate the number of H2 tag collisions in the node hash map.
+         * 
+         * @return int The number of tag collisions.
+         */
+        int calculateCollisionCountBuckets(void) override {
+            return internalcalculateCollisionCountTags(map);
+        }
+
+        /**
+         * @brief Clear the container benchmark between executions.
+         */
+        void clearContainer(void) override{
+            map.clear();
+        }
+
+        /**
+         * @brief Get the hash function used by the node hash map.
+         * 
+         * @return std::function<std::size_t(const std::string&)> The hash function.
+         */
+        std::function<std::size_t(const std::string&)> getHashFunction(void) override {
+            return map.hash_function();
+        }
+};
+
+/**
+ * @brief A benchmarking class for the adaptive hash map, which synthesizes its hash function from the first inserted keys.
+ * 
+ * @tparam HashFuncT The type of the hash function. Must be accepted by AdaptiveHashMap.
+ */
+template <typename HashFuncT>
+class AdaptiveMapBench : public Benchmark{
+    AdaptiveHashMap<int, HashFuncT> map; ///< The adaptive hash map used for benchmarking.
+
+    public:
+        /**
+         * @brief Construct a new Adaptive Map Bench object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         */
+        AdaptiveMapBench(std::string _name, std::string _hashName) : 
+            Benchmark(_name, _hashName)
+            {}
+
+        /**
+         * @brief Insert a key into the adaptive hash map.
+         * 
+         * @param key The key to insert.
+         */
+        void insert(const std::string& key) override {
+            map[key] = 0;
+        }
+
+        /**
+         * @brief Search for a key in the adaptive hash map.
+         * 
+         * @param key The key to search for.
+         * @return true If the key is found.
+         * @return false Otherwise.
+         */
+        bool search(const std::string& key) override {
+            return map.find(key) != map.end();
+        }
+
+        /**
+         * @brief Remove a key from the adaptive hash map.
+         * 
+         * @param key The key to remove.
+         */
+        void elimination(const std::string& key) override {
+            map.erase(key);
+        }
+
+        /**
+         * @brief Calculate the number of collision buckets in the adaptive hash map.
+         * 
+         * @return int The number of collision buckets.
+         */
+        int calculateCollisionCountBuckets(void) override {
+            return internalcalculateCollisionCountBuckets(map.container());
+        }
+
+        /**
+         * @brief Clear the container benchmark between executions. The warm-up window starts again.
+         */
+        void clearContainer(void) override{
+            map.clear();
+        }
+
+        /**
+         * @brief Get the hash function currently used by the adaptive hash map.
+         * 
+         * @return std::function<std::size_t(const std::string&)> The hash function.
+         */
+        std::function<std::size_t(const std::string&)> getHashFunction(void) override {
+            return map.hash_function();
+        }
+};
+
+/**
+ * @brief A benchmarking class for a collision monitored unordered map, which falls back to AbseilHash when it degrades.
+ * 
+ * @tparam HashFuncT The type of the primary hash function.
+ */
+template <typename HashFuncT>
+class MonitoredMapBench : public Benchmark{
+    CollisionMonitor<std::unordered_map<std::string, int, MonitoredHash<HashFuncT>>> map; ///< The monitored unordered map used for benchmarking.
+
+    public:
+        /**
+         * @brief Construct a new Monitored Map Bench object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         */
+        MonitoredMapBench(std::string _name, std::string _hashName) : 
+            Benchmark(_name, _hashName)
+            {}
+
+        /**
+         * @brief Insert a key into the monitored unordered map.
+         * 
+         * @param key The key to insert.
+         */
+        void insert(const std::string& key) override {
+            map.insert(std::make_pair(key, 0));
+        }
+
+        /**
+         * @brief Search for a key in the monitored unordered map.
+         * 
+         * @param key The key to search for.
+         * @return true If the key is found.
+         * @return false Otherwise.
+         */
+        bool search(const std::string& key) override {
+            return map.find(key) != map.end();
+        }
+
+        /**
+         * @brief Remove a key from the monitored unordered map.
+         * 
+         * @param key The key to remove.
+         */
+        void elimination(const std::string& key) override {
+            map.erase(key);
+        }
+
+        /**
+         * @brief Calculate the number of collision buckets in the monitored unordered map.
+         * 
+         * @return int The number of collision buckets.
+         */
+        int calculateCollisionCountBuckets(void) override {
+            return internalcalculateCollisionCountBuckets(map.get());
+        }
+
+        /**
+         * @brief Clear the container benchmark between executions. The primary hash function is used again.
+         */
+        void clearContainer(void) override{
+            map.clear();
+        }
+
+        /**
+         * @brief Get the hash function currently used by the monitored unordered map.
+         * 
+         * @return std::function<std::size_t(const std::string&)> The hash function.
+         */
+        std::function<std::size_t(const std::string&)> getHashFunction(void) override {
+            return map.get().hash_function();
+        }
+};
+
+/**
+ * @brief A benchmarking class for a collision monitored unordered set, which falls back to AbseilHash when it degrades.
+ * 
+ * @tparam HashFuncT The type of the primary hash function.
+ */
+template <typename HashFuncT>
+class MonitoredSetBench : public Benchmark{
+    CollisionMonitor<std::unordered_set<std::string, MonitoredHash<HashFuncT>>> set; ///< The monitored unordered set used for benchmarking.
+
+    public:
+        /**
+         * @brief Construct a new Monitored Set Bench object.
+         * 
+         * @param _name The name of the benchmark.
+         * @param _hashName The name of the hash function.
+         */
+        MonitoredSetBench(std::string _name, std::string _hashName) : 
+            Benchmark(_name, _hashName)
+            {}
+
+        /**
+         * @brief Insert a key into the monitored unordered set.
+         * 
+         * @param key The key to insert.
+         */
+        void insert(const std::string& key) override {
+            set.insert(key);
+        }
+
+        /**
+         * @brief Search for a key in the monitored unordered set.
+         * 
+         * @param key The key to search for.
+         * @return true If the key is found.
+         * @return false Otherwise.
+         */
+        bool search(const std::string& key) override {
+            return set.find(key) != set.end();
+        }
+
+        /**
+         * @brief Remove a key from the monitored unordered set.
+         * 
+         * @param key The key to remove.
+         */
+        void elimination(const std::string& key) override {
+            set.erase(key);
+        }
+
+        /**
+         * @brief Calculate the number of collision buckets in the monitored unordered set.
+         * 
+         * @return int The number of collision buckets.
+         */
+        int calculateCollisionCountBuckets(void) override {
+            return internalcalculateCollisionCountBuckets(set.get());
+        }
+
+        /**
+         * @brief Clear the container benchmark between executions. The primary hash function is used again.
+         */
+        void clearContainer(void) override{
+            set.clear();
+        }
+
+        /**
+         * @brief Get the hash function currently used by the monitored unordered set.
+         * 
+         * @return std::function<std::size_t(const std::string&)> The hash function.
+         */
+        std::function<std::size_t(const std::string&)> getHashFunction(void) override {
+            return set.get().hash_function();
+        }
+};
+
 /**
  * @brief Struct to hold parameters for benchmarking.
  */
@@ -433,6 +1021,20 @@ struct BenchmarkParameters{
     bool testDistribution = false; ///< Flag to test distribution.
     bool hashPerformance = false; ///< Flag to test hash performance.
     std::string distribution = "normal"; ///< Distribution to use for testing.
+    bool monitor        = false; ///< Flag to also benchmark the collision monitored containers.
+    std::string samplingFile; ///< Sample file of the SamplingHash benchmarks. Empty disables them.
+    std::size_t samplingPeriod = 4096; ///< Number of hashed keys between two samples of a thread.
+    std::string layoutFile; ///< Layout table of the runtime hash functions, synthesized by `keysynth --layout`.
+    bool sortPerformance = false; ///< Flag to test radix sorting on the layout's sort key against std::sort.
+    unsigned partitionBits = 0; ///< Number of bits of the partitioning benchmark, for 2^k partitions. Zero disables it.
+    unsigned threads    = 0; ///< Number of threads of the partitioning benchmark. Zero means all hardware threads.
+    unsigned familySize = 0; ///< Number of functions of the independence test. Zero disables it.
+    std::string fieldFile; ///< Delimited file of the embedded fields benchmark, read instead of stdin. May be empty.
+    unsigned fieldColumn = 0; ///< Column of the keys in the delimited file.
+    char delimiter      = ','; ///< Delimiter of the columns of the delimited file.
+    unsigned padding    = 0; ///< Readable bytes after every key of the padded arena benchmark. Zero disables it.
+    std::string buildIndexFile; ///< Index file to build from the keys and values. May be empty.
+    std::string indexFile; ///< Index file to test against std::unordered_map. May be empty.
 };
 
 /**
@@ -495,6 +1097,97 @@ void testHashPerformance(const std::vector<Benchmark*>& benchmarks,
                          const std::vector<std::string>& keys,
                          const BenchmarkParameters& args);
 
+/**
+ * @brief Tests the performance of radix sorting the keys by their sort key, against std::sort.
+ *
+ * This function sorts copies of the keys with std::sort, and with a LSD radix sort on the sort keys extracted by
+ * RuntimeSortKey, and prints to standard output the elapsed time in seconds of both. The time of the radix sort
+ * includes extracting the sort keys and gathering the sorted strings.
+ *
+ * @param keys A constant reference to a vector of strings that represent the keys to be sorted.
+ * @param sortKey The sort key extractor. Must have at most 128 bits.
+ * @param args A constant reference to the BenchmarkParameters object that contains the parameters for the benchmark.
+ */
+void testSortPerformance(const std::vector<std::string>& keys,
+                         const RuntimeSortKey& sortKey,
+                         const BenchmarkParameters& args);
+
+/**
+ * @brief Tests the throughput and the skew of parallel radix partitioning, with the layout's partition function and
+ * with full hash functions.
+ *
+ * Every thread counts the partitions of its slice of the keys, and then scatters the slice into its place of each
+ * partition. This function prints to standard output, for every partition function, the elapsed time in seconds, the
+ * number of keys partitioned per second by each thread, and the skew, i.e. the size of the largest partition divided by
+ * the mean size.
+ *
+ * @param keys A constant reference to a vector of strings that represent the keys to be partitioned.
+ * @param partition The partition function synthesized from the layout.
+ * @param args A constant reference to the BenchmarkParameters object that contains the parameters for the benchmark.
+ */
+void testPartitionPerformance(const std::vector<std::string>& keys,
+                              const RuntimePartition& partition,
+                              const BenchmarkParameters& args);
+
+/**
+ * @brief Tests whether the functions of a hash family are pairwise independent on the keys.
+ *
+ * For every pair of functions, this function prints to standard output how often both hash a key into the same of
+ * 1024 buckets, relative to the 1/1024 expected from independent functions, and the chi-square statistic of their
+ * joint distribution over 64x64 buckets, divided by its degrees of freedom. Both should be close to 1.
+ *
+ * @param keys A constant reference to a vector of strings that represent the keys to be hashed.
+ * @param family The family of hash functions synthesized from the layout.
+ * @param args A constant reference to the BenchmarkParameters object that contains the parameters for the benchmark.
+ */
+void testIndependence(const std::vector<std::string>& keys,
+                      const RuntimePextFamily& family,
+                      const BenchmarkParameters& args);
+
+/**
+ * @brief Tests the execution time of hashing a column of a memory mapped delimited file, with and without copies.
+ *
+ * Every line of the file is split at its delimiters. The "substr" access copies the field into a std::string, as
+ * functors taking `const std::string&` need, and the "hash_at" access finds the field with findField and hashes it in
+ * place. Both use the Pext hash function of the layout. This function prints to standard output the elapsed time in
+ * seconds and the number of fields hashed of each access.
+ *
+ * @param layout The layout synthesized for the keys of the column.
+ * @param args A constant reference to the BenchmarkParameters object that contains the parameters for the benchmark.
+ */
+void testFieldPerformance(const PextLayout& layout, const BenchmarkParameters& args);
+
+/**
+ * @brief Tests the execution time of the Pext hash function on keys with and without readable padding.
+ *
+ * The keys are hashed by RuntimePaddedPextHash three times: from their std::string buffers with the loads of the
+ * layout, from a PaddedKeyArena with the same loads, and from the arena with the padded loads of padPextLayout. This
+ * function prints to standard output the storage of the keys, the kind of loads, their number, and the elapsed time in
+ * seconds of each.
+ *
+ * @param keys A constant reference to a vector of strings that represent the keys to be hashed.
+ * @param layout The layout synthesized for the keys.
+ * @param args A constant reference to the BenchmarkParameters object that contains the parameters for the benchmark.
+ */
+void testPaddedPerformance(const std::vector<std::string>& keys,
+                           const PextLayout& layout,
+                           const BenchmarkParameters& args);
+
+/**
+ * @brief Tests the startup and lookup times of a memory mapped index, against rebuilding an std::unordered_map.
+ *
+ * The startup of the index only maps its file, while the startup of the std::unordered_map inserts every entry. Both
+ * then search every key of the entries. This function prints to standard output the startup and lookup times in
+ * seconds, and the number of keys found, for both.
+ *
+ * @param entries A constant reference to a vector of key/value pairs, the ones the index was built from.
+ * @param indexFile The path of the index file, built by buildStaticIndex.
+ * @param args A constant reference to the BenchmarkParameters object that contains the parameters for the benchmark.
+ */
+void testIndexPerformance(const std::vector<std::pair<std::string, std::string>>& entries,
+                          const std::string& indexFile,
+                          const BenchmarkParameters& args);
+
 /**
  * @brief Frees the memory allocated for the benchmarks.
  * 
@@ -0,0 +1,194 @@
+/**
+ * @file collisionMonitor.hpp
+ * @brief This file contains a wrapper for unordered containers that falls back to a stronger hash function when
+ * the synthesized one starts colliding.
+ */
+
+#ifndef COLLISION_MONITOR_HPP
+#define COLLISION_MONITOR_HPP
+
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "customHashes.hpp"
+
+/**
+ * @brief Default number of insertions between two samples of the container's buckets.
+ */
+constexpr std::size_t MONITOR_SAMPLE_PERIOD = 1024;
+
+/**
+ * @brief Number of consecutive buckets read by each sample.
+ */
+constexpr std::size_t MONITOR_SAMPLED_BUCKETS = 64;
+
+/**
+ * @brief Default ratio between the sampled probe length and the probe length expected from a uniform hash function
+ * above which the container falls back.
+ */
+constexpr double MONITOR_MAX_PROBE_RATIO = 4.0;
+
+/**
+ * @brief Hash function that forwards to a primary hash function, or to a fallback one once it has been switched.
+ *
+ * @tparam PrimaryHashT The type of the primary hash function, usually a synthesized one.
+ * @tparam FallbackHashT The type of the fallback hash function.
+ */
+template <typename PrimaryHashT, typename FallbackHashT = AbseilHash>
+struct MonitoredHash{
+    bool useFallback = false; ///< Whether the fallback hash function is used.
+    PrimaryHashT primary; ///< The primary hash function object.
+    FallbackHashT fallback; ///< The fallback hash function object.
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key The std::string key to hash.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key) const {
+        return useFallback ? fallback(key) : primary(key);
+    }
+};
+
+/**
+ * @brief A wrapper for the std unordered containers that monitors their buckets and rehashes them once into the
+ * fallback hash function when they degrade.
+ *
+ * Every `samplePeriod` insertions, a window of consecutive buckets is read with bucket_size(), the same data used by
+ * Benchmark::calculateCollisionCountBuckets. The average probe length of the elements in the window is compared with the
+ * one expected from a uniform hash function at the current load factor, 1 + load_factor / 2. Above `maxProbeRatio` times
+ * the expected length, the container is rebuilt with the fallback hash function, and the monitoring stops.
+ *
+ * Multi containers keep equal keys in the same bucket regardless of the hash function, so many duplicated keys may also
+ * trigger the fallback.
+ *
+ * @tparam ContainerT The type of the unordered container. Its hasher must be a MonitoredHash.
+ */
+template <typename ContainerT>
+class CollisionMonitor{
+    ContainerT container; ///< The monitored container.
+    std::size_t samplePeriod; ///< Number of insertions between two samples.
+    double maxProbeRatio; ///< Maximum ratio between the sampled and the expected probe lengths.
+    std::size_t insertions = 0; ///< Number of insertions since the last sample.
+    std::size_t nextBucket = 0; ///< First bucket of the next sample.
+    bool fellBack = false; ///< Whether the container already uses the fallback hash function.
+
+    /**
+     * @brief Samples a window of buckets and checks whether their probe lengths are too long.
+     *
+     * @return true If the container is degraded.
+     * @return false Otherwise.
+     */
+    bool degraded(){
+        const std::size_t bucketCount = container.bucket_count();
+        const std::size_t sampled = bucketCount < MONITOR_SAMPLED_BUCKETS ? bucketCount : MONITOR_SAMPLED_BUCKETS;
+
+        std::size_t elements = 0;
+        std::size_t probes = 0;
+        for(std::size_t i = 0; i < sampled; i++){
+            const std::size_t size = container.bucket_size((nextBucket + i) % bucketCount);
+            elements += size;
+            probes += size * (size + 1) / 2;
+        }
+        // Move the window by a large odd stride, so consecutive samples read different buckets
+        nextBucket = (nextBucket + 7919 * MONITOR_SAMPLED_BUCKETS) % bucketCount;
+
+        const double loadFactor = container.load_factor();
+        if(elements == 0){
+            // A uniform hash function leaves a window expected to hold 16 elements empty with negligible probability
+            return loadFactor * sampled >= 16.0;
+        }
+        const double probeLength = (double)probes / elements;
+        return probeLength > maxProbeRatio * (1.0 + loadFactor / 2.0);
+    }
+
+    /**
+     * @brief Rebuilds the container with the fallback hash function.
+     */
+    void fallBack(){
+        auto hash = container.hash_function();
+        hash.useFallback = true;
+        ContainerT rehashed(container.bucket_count(), hash);
+        rehashed.insert(std::make_move_iterator(container.begin()), std::make_move_iterator(container.end()));
+        container.swap(rehashed);
+        fellBack = true;
+    }
+
+    public:
+        using value_type = typename ContainerT::value_type;
+        using key_type = typename ContainerT::key_type;
+        using iterator = typename ContainerT::iterator;
+
+        /**
+         * @brief Construct a new Collision Monitor object.
+         *
+         * @param _samplePeriod Number of insertions between two samples of the buckets.
+         * @param _maxProbeRatio Maximum ratio between the sampled and the expected probe lengths.
+         */
+        explicit CollisionMonitor(std::size_t _samplePeriod = MONITOR_SAMPLE_PERIOD,
+                                  double _maxProbeRatio = MONITOR_MAX_PROBE_RATIO) :
+            samplePeriod(_samplePeriod),
+            maxProbeRatio(_maxProbeRatio)
+            {}
+
+        /**
+         * @brief Insert a value into the container, sampling its buckets every `samplePeriod` insertions.
+         *
+         * @param value The value to insert.
+         */
+        void insert(const value_type& value){
+            container.insert(value);
+            if(fellBack || ++insertions < samplePeriod){
+                return;
+            }
+            insertions = 0;
+            if(degraded()){
+                fallBack();
+            }
+        }
+
+        /**
+         * @brief Search for a key in the container.
+         *
+         * @param key The key to search for.
+         * @return iterator The iterator to the key, or end() if it is not found.
+         */
+        iterator find(const key_type& key){ return container.find(key); }
+
+        /**
+         * @brief Get the past-the-end iterator of the container.
+         */
+        iterator end(){ return container.end(); }
+
+        /**
+         * @brief Remove a key from the container.
+         *
+         * @param key The key to remove.
+         * @return std::size_t The number of removed elements.
+         */
+        std::size_t erase(const key_type& key){ return container.erase(key); }
+
+        /**
+         * @brief Remove every element and go back to the primary hash function.
+         */
+        void clear(){
+            container = ContainerT();
+            insertions = 0;
+            nextBucket = 0;
+            fellBack = false;
+        }
+
+        /**
+         * @brief Whether the container uses the fallback hash function.
+         */
+        bool hasFallenBack() const { return fellBack; }
+
+        /**
+         * @brief Get the monitored container.
+         */
+        const ContainerT& get() const { return container; }
+};
+
+#endif
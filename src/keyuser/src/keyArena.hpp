@@ -0,0 +1,70 @@
+/**
+ * @file keyArena.hpp
+ * @brief This file contains an arena of keys with readable padding after every key, for the padded hash functions.
+ */
+
+#ifndef KEY_ARENA_HPP
+#define KEY_ARENA_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Largest padding of an arena. The padded loads read at most 15 bytes past a key, so more is never needed.
+ */
+constexpr std::size_t MAX_ARENA_PADDING = 4096;
+
+/**
+ * @brief Keys stored back to back with an aligned stride, followed by padding.
+ *
+ * Every key starts at a multiple of 8 bytes, and at least `padding` readable bytes follow it: the next keys, and zeroes
+ * after the last one. Hash functions synthesized by `keysynth --padded` may then read past the end of the keys.
+ */
+class PaddedKeyArena{
+    std::vector<uint64_t> storage; ///< The keys and the padding, as 8 bytes words so every key is aligned.
+    std::size_t keyStride = 0; ///< Distance between the first bytes of consecutive keys.
+    std::size_t numKeys = 0; ///< Number of keys in the arena.
+
+    public:
+        /**
+         * @brief Construct a new Padded Key Arena object.
+         *
+         * @param keys The keys to copy into the arena.
+         * @param padding Number of readable bytes guaranteed after the end of every key.
+         */
+        PaddedKeyArena(const std::vector<std::string>& keys, std::size_t padding) :
+            numKeys(keys.size())
+            {
+                std::size_t maxSize = 0;
+                for(const auto& key : keys){
+                    maxSize = key.size() > maxSize ? key.size() : maxSize;
+                }
+                keyStride = (maxSize + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+                storage.assign((numKeys * keyStride + padding + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+                char* bytes = (char*)storage.data();
+                for(std::size_t i = 0; i < numKeys; i++){
+                    memcpy(bytes + i * keyStride, keys[i].data(), keys[i].size());
+                }
+            }
+
+        /**
+         * @brief Get a pointer to a key of the arena.
+         *
+         * @param i The index of the key.
+         */
+        const char* operator[](std::size_t i) const { return (const char*)storage.data() + i * keyStride; }
+
+        /**
+         * @brief Get the number of keys in the arena.
+         */
+        std::size_t size() const { return numKeys; }
+
+        /**
+         * @brief Get the distance between the first bytes of consecutive keys.
+         */
+        std::size_t stride() const { return keyStride; }
+};
+
+#endif
@@ -12,8 +12,11 @@
 #include <functional>
 #include <unordered_map>
 
+#include "abslAdapters.hpp"
 #include "benchmarks.hpp"
 #include "customHashes.hpp"
+#include "runtimeHashes.hpp"
+#include "samplingHash.hpp"
 #include "registry.hpp"
 
 std::string correctBenchUsage(){
@@ -22,13 +25,34 @@ std::string correctBenchUsage(){
            "       -i or --insert: integer that represents the percentage of insertion operations\n"
            "       -s or --search: integer that represents the percentage of search operations\n"
            "       -e or --elimination: integer that represents the percentage of elimination operations\n"
-           "               The sum of -i, -s, and -e should be 100.\n"
+           "               The sum of -i, -s, and -e should be 100. The sort, partition, independence, field, padded, and\n"
+           "               index tests only read the keys, so they need none of -i, -s, -e, and -n\n"
            "       -n or --num-operations: integer that represents the number of 'times to perform a hash operation on the benchmark\n"
            "       -r or --repetitions: number of times to repeat the benchmark\n"
            "       -seed: integer that represents the seed for the random number generator\n "
            "       --test-distribution: test the distribution of '--hashes' specified hash functions\n"
            "       --distribution: specify the randon distribution of the keys to be used in the benchmark\n"
            "       --hash-performance: test the execution time of the hash functions over a set of keys\n"  
+           "       --monitor: also benchmark the collision monitored containers, which fall back to AbseilHash\n"
+           "       --sampling <file>: also benchmark every hash wrapped by SamplingHash, which samples the hashed keys\n"
+           "               into <file> for keybuilder. Its hash name is SamplingHash<hash>\n"
+           "       --sampling-period <number>: number of keys hashed by each thread between two samples, defaults to 4096\n"
+           "       --layout <file>: layout table synthesized by `keysynth --layout`, enables the RuntimePext, RuntimeOffXor, and\n"
+           "               RuntimeMinimalPerfect hashes, the last one built from the keys read from stdin\n"
+           "       --partition-performance <k>: test the throughput and skew of splitting the keys into 2^k partitions in parallel,\n"
+           "               with the partition function of '--layout' and with full hash functions\n"
+           "       --threads <number>: number of threads of '--partition-performance', defaults to all hardware threads\n"
+           "       --test-independence <k>: test whether the k hash functions of the family of '--layout' are pairwise independent\n"
+           "       --sort-performance: test the execution time of radix sorting the keys by the sort key of '--layout', against std::sort\n"
+           "       --field-performance <file> <column>: test the execution time of hashing a column of a memory mapped\n"
+           "               delimited file with the Pext hash of '--layout', copying the fields and in place. Stdin is not read\n"
+           "       --delimiter <char>: delimiter of the columns of '--field-performance', defaults to ','\n"
+           "       --padded-performance <N>: test the execution time of the Pext hash of '--layout' on keys followed by N readable\n"
+           "               bytes, 8 to 4096, with the layout's loads and with the padded loads of 'keysynth --padded'\n"
+           "       --build-index <file>: build a memory mapped index of the keys with the minimal perfect hash of '--layout'.\n"
+           "               Each line is a key, optionally followed by a tab and its value\n"
+           "       --index-performance <file>: test the startup and lookup times of an index built by '--build-index',\n"
+           "               against rebuilding an std::unordered_map from the same lines\n"
            "       -v or --verbose: print the results of each operation\n"
            "       -h or --help: print this message\n"
            ;
@@ -78,6 +102,53 @@ BenchmarkParameters parseArgs(int argc, char** argv){
         }else if(strcmp(argv[i], "--hash-performance") == 0){
             args.hashPerformance = true;
             i++;
+        }else if(strcmp(argv[i], "--partition-performance") == 0 && i + 1 < argc){
+            args.partitionBits = atoi(argv[i+1]);
+            i+=2;
+        }else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc){
+            args.threads = atoi(argv[i+1]);
+            i+=2;
+        }else if(strcmp(argv[i], "--test-independence") == 0 && i + 1 < argc){
+            args.familySize = atoi(argv[i+1]);
+            i+=2;
+        }else if(strcmp(argv[i], "--sort-performance") == 0){
+            args.sortPerformance = true;
+            i++;
+        }else if(strcmp(argv[i], "--field-performance") == 0 && i + 2 < argc){
+            args.fieldFile = argv[i+1];
+            args.fieldColumn = atoi(argv[i+2]);
+            i+=3;
+        }else if(strcmp(argv[i], "--delimiter") == 0 && i + 1 < argc){
+            args.delimiter = argv[i+1][0];
+            i+=2;
+        }else if(strcmp(argv[i], "--padded-performance") == 0 && i + 1 < argc){
+            // atoi would turn "-5" into a huge unsigned, so only short runs of digits are accepted
+            const bool digits = strlen(argv[i+1]) <= 4 && strspn(argv[i+1], "0123456789") == strlen(argv[i+1]);
+            args.padding = digits ? atoi(argv[i+1]) : 0;
+            if(args.padding < 8 || args.padding > MAX_ARENA_PADDING){
+                fprintf(stderr, "Invalid padding: %s, the padded loads read up to 7 bytes past the keys, so it must be "
+                                "between 8 and %lu.\n", argv[i+1], MAX_ARENA_PADDING);
+                exit(1);
+            }
+            i+=2;
+        }else if(strcmp(argv[i], "--build-index") == 0 && i + 1 < argc){
+            args.buildIndexFile = argv[i+1];
+            i+=2;
+        }else if(strcmp(argv[i], "--index-performance") == 0 && i + 1 < argc){
+            args.indexFile = argv[i+1];
+            i+=2;
+        }else if(strcmp(argv[i], "--monitor") == 0){
+            args.monitor = true;
+            i++;
+        }else if(strcmp(argv[i], "--sampling") == 0 && i + 1 < argc){
+            args.samplingFile = argv[i+1];
+            i+=2;
+        }else if(strcmp(argv[i], "--sampling-period") == 0 && i + 1 < argc){
+            args.samplingPeriod = strtoul(argv[i+1], nullptr, 10);
+            i+=2;
+        }else if(strcmp(argv[i], "--layout") == 0 && i + 1 < argc){
+            args.layoutFile = argv[i+1];
+            i+=2;
         }else if(strcmp(argv[i], "--distribution") == 0){
             i++;
             std::string distribution = argv[i];
@@ -100,8 +171,11 @@ BenchmarkParameters parseArgs(int argc, char** argv){
             exit(1);
         }
     }
+    // These tests only read the keys, so they ignore the mix of operations
+    const bool specialMode = args.sortPerformance || args.familySize || args.partitionBits || !args.fieldFile.empty() ||
+                             args.padding || !args.buildIndexFile.empty() || !args.indexFile.empty();
     int sumArgs = args.insert + args.search + args.elimination;
-    if ( sumArgs != 100 ){
+    if ( !specialMode && sumArgs != 100 ){
         fprintf(stderr, "Missing insert, search, or elimination arguments.\n");
         fprintf(stderr, "%s", correctBenchUsage().c_str());
         exit(1);
@@ -109,6 +183,42 @@ BenchmarkParameters parseArgs(int argc, char** argv){
     return args;
 }
 
+/**
+ * @brief Registers the benchmarks of the hash functions driven by a layout table.
+ *
+ * The runtime hash functions are templated on the number of loads, so we pick the instantiation matching the layout.
+ *
+ * @tparam N The number of loads to try.
+ * @param benchmarks The benchmarks to register into.
+ * @param layout The layout table synthesized by keysynth.
+ */
+template <std::size_t N = MAX_RUNTIME_LOADS>
+void registerRuntimeBenchmarks(std::vector<Benchmark*>& benchmarks, const PextLayout& layout){
+    if constexpr (N > 0) {
+        if(layout.loads.size() != N){
+            registerRuntimeBenchmarks<N-1>(benchmarks, layout);
+            return;
+        }
+        REGISTER_RUNTIME_BENCHMARKS(RuntimePextHash<N>, "RuntimePext", RuntimePextHash<N>(layout));
+        REGISTER_RUNTIME_BENCHMARKS(RuntimeOffXorHash<N>, "RuntimeOffXor", RuntimeOffXorHash<N>(layout));
+    }
+}
+
+/**
+ * @brief Stops the key sampler of the SamplingHash benchmarks, and reports how many keys it sampled.
+ *
+ * @param args The parameters of the benchmarks.
+ */
+void stopSampling(const BenchmarkParameters& args){
+    if(args.samplingFile.empty()){
+        return;
+    }
+    KeySampler& sampler = KeySampler::instance();
+    sampler.stop();
+    fprintf(stderr, "# Sampled %lu keys into %s, dropped %lu\n",
+            sampler.samplesWritten(), args.samplingFile.c_str(), sampler.samplesDropped());
+}
+
 int main(int argc, char** argv){
 
     BenchmarkParameters args = parseArgs(argc, argv);
@@ -118,14 +228,138 @@ int main(int argc, char** argv){
 
     // Register Benchmarks with a macro for beter legibility
     REGISTER_ALL_BENCHMARKS
+    if(args.monitor){
+        REGISTER_ALL_MONITORED_BENCHMARKS
+    }
+    if(!args.samplingFile.empty()){
+        if(!KeySampler::instance().start(args.samplingFile, args.samplingPeriod)){
+            fprintf(stderr, "Could not write the sample file %s\n", args.samplingFile.c_str());
+            exit(1);
+        }
+        REGISTER_ALL_SAMPLING_BENCHMARKS
+    }
 
-    // Load keys from standard input into memory
+    // Load keys from standard input into memory, unless they come from a file
     std::vector<std::string> keys;
     std::string line;
-    while(std::getline(std::cin, line)){
+    while(args.fieldFile.empty() && std::getline(std::cin, line)){
         keys.push_back(line);
     }
 
+    // Register hashes whose masks are only known at runtime
+    PextLayout layout;
+    if(!args.layoutFile.empty()){
+        if(!readPextLayout(args.layoutFile, layout)){
+            fprintf(stderr, "Invalid layout file: %s\n", args.layoutFile.c_str());
+            exit(1);
+        }
+        if(layout.loads.size() > MAX_RUNTIME_LOADS){
+            fprintf(stderr, "Layout has %lu loads, but at most %lu are supported.\n", layout.loads.size(), MAX_RUNTIME_LOADS);
+            exit(1);
+        }
+        registerRuntimeBenchmarks(benchmarks, layout);
+
+        // The minimal perfect hash function is built for the keys that will be benchmarked
+        RuntimeMinimalPerfectHash mph;
+        const bool hashBenchmarks = !args.sortPerformance && !args.familySize && !args.partitionBits && !args.padding &&
+                                    args.fieldFile.empty() && args.buildIndexFile.empty() && args.indexFile.empty();
+        if(hashBenchmarks && buildMinimalPerfectHash(layout, keys, mph)){
+            REGISTER_RUNTIME_BENCHMARKS(RuntimeMinimalPerfectHash, "RuntimeMinimalPerfect", mph);
+        }else if(hashBenchmarks){
+            fprintf(stderr, "WARNING: no minimal perfect hash function of the keys with this layout, skipping RuntimeMinimalPerfect.\n");
+        }
+    }
+
+    if(args.sortPerformance){
+        if(args.layoutFile.empty()){
+            fprintf(stderr, "--sort-performance needs the layout of the keys, use --layout <file>.\n");
+            exit(1);
+        }
+        RuntimeSortKey sortKey(layout);
+        if(sortKey.bits > 128){
+            fprintf(stderr, "The layout has %u variable bits, but sort keys have at most 128.\n", sortKey.bits);
+            exit(1);
+        }
+        freeBenchmarks(benchmarks);
+        testSortPerformance(keys, sortKey, args);
+        return 0;
+    }
+
+    if(args.familySize){
+        if(args.layoutFile.empty()){
+            fprintf(stderr, "--test-independence needs the layout of the keys, use --layout <file>.\n");
+            exit(1);
+        }
+        freeBenchmarks(benchmarks);
+        testIndependence(keys, RuntimePextFamily(layout), args);
+        return 0;
+    }
+
+    if(args.partitionBits){
+        if(args.layoutFile.empty()){
+            fprintf(stderr, "--partition-performance needs the layout of the keys, use --layout <file>.\n");
+            exit(1);
+        }
+        if(args.partitionBits > 16){
+            fprintf(stderr, "At most 2^16 partitions are supported.\n");
+            exit(1);
+        }
+        RuntimePartition partition(layout, args.partitionBits, keys);
+        if(partition.bits < args.partitionBits){
+            fprintf(stderr, "WARNING: the partition load has only %u variable bits, using 2^%u partitions.\n",
+                    partition.bits, partition.bits);
+        }
+        freeBenchmarks(benchmarks);
+        testPartitionPerformance(keys, partition, args);
+        return 0;
+    }
+
+    if(!args.fieldFile.empty()){
+        if(args.layoutFile.empty()){
+            fprintf(stderr, "--field-performance needs the layout of the keys, use --layout <file>.\n");
+            exit(1);
+        }
+        freeBenchmarks(benchmarks);
+        testFieldPerformance(layout, args);
+        return 0;
+    }
+
+    if(args.padding){
+        if(args.layoutFile.empty()){
+            fprintf(stderr, "--padded-performance needs the layout of the keys, use --layout <file>.\n");
+            exit(1);
+        }
+        freeBenchmarks(benchmarks);
+        testPaddedPerformance(keys, layout, args);
+        return 0;
+    }
+
+    if(!args.buildIndexFile.empty() || !args.indexFile.empty()){
+        std::vector<std::pair<std::string, std::string>> entries;
+        entries.reserve(keys.size());
+        for(const auto& entry : keys){
+            const std::size_t tab = entry.find('\t');
+            entries.emplace_back(entry.substr(0, tab), tab == std::string::npos ? "" : entry.substr(tab + 1));
+        }
+        freeBenchmarks(benchmarks);
+
+        if(!args.buildIndexFile.empty()){
+            if(args.layoutFile.empty()){
+                fprintf(stderr, "--build-index needs the layout of the keys, use --layout <file>.\n");
+                exit(1);
+            }
+            if(!buildStaticIndex(layout, entries, args.buildIndexFile)){
+                fprintf(stderr, "Could not build the index %s, the layout may collide on the keys.\n",
+                        args.buildIndexFile.c_str());
+                exit(1);
+            }
+        }
+        if(!args.indexFile.empty()){
+            testIndexPerformance(entries, args.indexFile, args);
+        }
+        return 0;
+    }
+
     // Fill default hash functions to run
     if(args.hashesToRun.empty()){
         args.hashesToRun.push_back("STDHashBin");
@@ -149,15 +383,18 @@ int main(int argc, char** argv){
     if(args.hashPerformance){
         testHashPerformance(filteredBenchmarks, keys, args);
         freeBenchmarks(filteredBenchmarks);
+        stopSampling(args);
         return 0;
     }
     if(args.testDistribution){
         testDistribution(filteredBenchmarks, keys);
         freeBenchmarks(filteredBenchmarks);
+        stopSampling(args);
         return 0;
     }
     benchmarkExecutor(filteredBenchmarks, keys, args);
     freeBenchmarks(filteredBenchmarks);
+    stopSampling(args);
 
 }
 
@@ -1,7 +1,7 @@
 /**
  * @file registry.hpp
  * @brief This file contains macros for registering benchmarks.
- * @brief New Custom Hash functions must be manually added to the REGISTER_ALL_BENCHMARKS macro.
+ * @brief New Custom Hash functions must be manually added to the FOR_ALL_HASHES macro.
  */
 
 /**
@@ -21,72 +21,152 @@
 #define REGISTER_BENCHMARKS(hashname)   benchmarks.push_back(DECLARE_ONE_BENCH(UnorderedMapBench, hashname)); \
                                         benchmarks.push_back(DECLARE_ONE_BENCH(UnorderedMultiMapBench, hashname)); \
                                         benchmarks.push_back(DECLARE_ONE_BENCH(UnorderedSetBench, hashname)); \
-                                        benchmarks.push_back(DECLARE_ONE_BENCH(UnorderedMultisetBench, hashname));
+                                        benchmarks.push_back(DECLARE_ONE_BENCH(UnorderedMultisetBench, hashname)); \
+                                        benchmarks.push_back(DECLARE_ONE_BENCH(FlatHashMapBench, hashname)); \
+                                        benchmarks.push_back(DECLARE_ONE_BENCH(FlatHashSetBench, hashname)); \
+                                        benchmarks.push_back(DECLARE_ONE_BENCH(NodeHashMapBench, hashname));
+
+/**
+ * @def REGISTER_MONITORED_BENCHMARKS(hashname)
+ * @brief This macro registers collision monitored benchmarks for a specific hash function.
+ * @param hashname The name of the hash function.
+ */
+#define REGISTER_MONITORED_BENCHMARKS(hashname) benchmarks.push_back(DECLARE_ONE_BENCH(MonitoredMapBench, hashname)); \
+                                                benchmarks.push_back(DECLARE_ONE_BENCH(MonitoredSetBench, hashname));
+
+/**
+ * @def REGISTER_SAMPLING_BENCHMARKS(hashname)
+ * @brief This macro registers benchmarks for a specific hash function wrapped by SamplingHash.
+ * @param hashname The name of the hash function.
+ */
+#define REGISTER_SAMPLING_BENCHMARKS(hashname) REGISTER_BENCHMARKS(SamplingHash<hashname>)
+
+/**
+ * @def REGISTER_ABSL_MIXED_BENCHMARKS(hashname)
+ * @brief This macro registers Swiss table benchmarks for a specific hash function mixed by absl::Hash through
+ * AbslHashValue, instead of consumed bare by the Swiss tables.
+ * @param hashname The name of the hash function.
+ */
+#define REGISTER_ABSL_MIXED_BENCHMARKS(hashname) \
+    benchmarks.push_back(DECLARE_ONE_BENCH(FlatHashMapBench, AbslMixedHash<hashname>)); \
+    benchmarks.push_back(DECLARE_ONE_BENCH(FlatHashSetBench, AbslMixedHash<hashname>)); \
+    benchmarks.push_back(DECLARE_ONE_BENCH(NodeHashMapBench, AbslMixedHash<hashname>));
+
+/**
+ * @def DECLARE_ONE_RUNTIME_BENCH(name, hashtype, hashname, hash)
+ * @brief This macro creates a new benchmark object whose hash function object is only known at runtime.
+ * @param name The name of the benchmark.
+ * @param hashtype The type of the hash function used in the benchmark.
+ * @param hashname The name of the hash function used in the benchmark.
+ * @param hash The hash function object used in the benchmark.
+ * @return A pointer to the new benchmark object.
+ */
+#define DECLARE_ONE_RUNTIME_BENCH(name, hashtype, hashname, hash) (Benchmark*)new name<hashtype>(#name,hashname,hash)
+
+/**
+ * @def REGISTER_RUNTIME_BENCHMARKS(hashtype, hashname, hash)
+ * @brief This macro registers benchmarks for a hash function object built at runtime.
+ * @param hashtype The type of the hash function.
+ * @param hashname The name of the hash function.
+ * @param hash The hash function object.
+ */
+#define REGISTER_RUNTIME_BENCHMARKS(hashtype, hashname, hash) \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(UnorderedMapBench, hashtype, hashname, hash)); \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(UnorderedMultiMapBench, hashtype, hashname, hash)); \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(UnorderedSetBench, hashtype, hashname, hash)); \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(UnorderedMultisetBench, hashtype, hashname, hash)); \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(FlatHashMapBench, hashtype, hashname, hash)); \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(FlatHashSetBench, hashtype, hashname, hash)); \
+    benchmarks.push_back(DECLARE_ONE_RUNTIME_BENCH(NodeHashMapBench, hashtype, hashname, hash));
+
+/**
+ * @def FOR_ALL_HASHES(MACRO)
+ * @brief This macro applies MACRO to every custom hash function.
+ * @param MACRO The macro to apply, receiving the name of the hash function.
+ */
+#define FOR_ALL_HASHES(MACRO) \
+    MACRO(AbseilHash) \
+    MACRO(STDHashBin) \
+    MACRO(STDHashSrc) \
+    MACRO(FNVHash) \
+    MACRO(CityHash) \
+    MACRO(IPV4HashUnrolled) \
+    MACRO(IPV4HashMove) \
+    MACRO(IntSimdHash) \
+    MACRO(PextUrlComplex) \
+    MACRO(PextUrl) \
+    MACRO(PextMac) \
+    MACRO(PextCPF) \
+    MACRO(PextSSN) \
+    MACRO(PextIPV4) \
+    MACRO(PextIPV6) \
+    MACRO(PextINTS) \
+    MACRO(OffXorUrlComplex) \
+    MACRO(OffXorUrl) \
+    MACRO(OffXorMac) \
+    MACRO(OffXorCPF) \
+    MACRO(OffXorSSN) \
+    MACRO(OffXorIPV4) \
+    MACRO(OffXorIPV6) \
+    MACRO(OffXorINTS) \
+    MACRO(NaiveUrlComplex) \
+    MACRO(NaiveUrl) \
+    MACRO(NaiveMac) \
+    MACRO(NaiveCPF) \
+    MACRO(NaiveSSN) \
+    MACRO(NaiveIPV4) \
+    MACRO(NaiveIPV6) \
+    MACRO(NaiveINTS) \
+    MACRO(AesUrlComplex) \
+    MACRO(AesUrl) \
+    MACRO(AesMac) \
+    MACRO(AesCPF) \
+    MACRO(AesSSN) \
+    MACRO(AesIPV4) \
+    MACRO(AesIPV6) \
+    MACRO(AesINTS) \
+    MACRO(NaiveSimdUrlComplex) \
+    MACRO(NaiveSimdUrl) \
+    MACRO(NaiveSimdIPV6) \
+    MACRO(NaiveSimdINTS) \
+    MACRO(GptUrlComplex) \
+    MACRO(GptUrl) \
+    MACRO(GptMac) \
+    MACRO(GptCPF) \
+    MACRO(GptSSN) \
+    MACRO(GptIPV4) \
+    MACRO(GptIPV6) \
+    MACRO(GptINTS) \
+    MACRO(GperfUrlComplex) \
+    MACRO(GperfUrl) \
+    MACRO(GperfMac) \
+    MACRO(GperfCPF) \
+    MACRO(GperfSSN) \
+    MACRO(GperfIPV4) \
+    MACRO(GperfIPV6) \
+    MACRO(GperfINTS) \
+    MACRO(PextMurmurUrlComplex) \
+    MACRO(PextMurmurINTS)
 
 /**
  * @def REGISTER_ALL_BENCHMARKS
  * @brief This macro registers all benchmarks for all hash functions.
  */
 #define REGISTER_ALL_BENCHMARKS \
-    REGISTER_BENCHMARKS(AbseilHash); \
-    REGISTER_BENCHMARKS(STDHashBin); \
-    REGISTER_BENCHMARKS(STDHashSrc); \
-    REGISTER_BENCHMARKS(FNVHash); \
-    REGISTER_BENCHMARKS(CityHash); \
-    REGISTER_BENCHMARKS(IPV4HashUnrolled); \
-    REGISTER_BENCHMARKS(IPV4HashMove); \
-    REGISTER_BENCHMARKS(IntSimdHash); \
-    REGISTER_BENCHMARKS(PextUrlComplex); \
-    REGISTER_BENCHMARKS(PextUrl); \
-    REGISTER_BENCHMARKS(PextMac); \
-    REGISTER_BENCHMARKS(PextCPF); \
-    REGISTER_BENCHMARKS(PextSSN); \
-    REGISTER_BENCHMARKS(PextIPV4); \
-    REGISTER_BENCHMARKS(PextIPV6); \
-    REGISTER_BENCHMARKS(PextINTS); \
-    REGISTER_BENCHMARKS(OffXorUrlComplex); \
-    REGISTER_BENCHMARKS(OffXorUrl); \
-    REGISTER_BENCHMARKS(OffXorMac); \
-    REGISTER_BENCHMARKS(OffXorCPF); \
-    REGISTER_BENCHMARKS(OffXorSSN); \
-    REGISTER_BENCHMARKS(OffXorIPV4); \
-    REGISTER_BENCHMARKS(OffXorIPV6); \
-    REGISTER_BENCHMARKS(OffXorINTS); \
-    REGISTER_BENCHMARKS(NaiveUrlComplex); \
-    REGISTER_BENCHMARKS(NaiveUrl); \
-    REGISTER_BENCHMARKS(NaiveMac); \
-    REGISTER_BENCHMARKS(NaiveCPF); \
-    REGISTER_BENCHMARKS(NaiveSSN); \
-    REGISTER_BENCHMARKS(NaiveIPV4); \
-    REGISTER_BENCHMARKS(NaiveIPV6); \
-    REGISTER_BENCHMARKS(NaiveINTS); \
-    REGISTER_BENCHMARKS(AesUrlComplex); \
-    REGISTER_BENCHMARKS(AesUrl); \
-    REGISTER_BENCHMARKS(AesMac); \
-    REGISTER_BENCHMARKS(AesCPF); \
-    REGISTER_BENCHMARKS(AesSSN); \
-    REGISTER_BENCHMARKS(AesIPV4); \
-    REGISTER_BENCHMARKS(AesIPV6); \
-    REGISTER_BENCHMARKS(AesINTS); \
-    REGISTER_BENCHMARKS(NaiveSimdUrlComplex); \
-    REGISTER_BENCHMARKS(NaiveSimdUrl); \
-    REGISTER_BENCHMARKS(NaiveSimdIPV6); \
-    REGISTER_BENCHMARKS(NaiveSimdINTS); \
-    REGISTER_BENCHMARKS(GptUrlComplex); \
-    REGISTER_BENCHMARKS(GptUrl); \
-    REGISTER_BENCHMARKS(GptMac); \
-    REGISTER_BENCHMARKS(GptCPF); \
-    REGISTER_BENCHMARKS(GptSSN); \
-    REGISTER_BENCHMARKS(GptIPV4); \
-    REGISTER_BENCHMARKS(GptIPV6); \
-    REGISTER_BENCHMARKS(GptINTS); \
-    REGISTER_BENCHMARKS(GperfUrlComplex); \
-    REGISTER_BENCHMARKS(GperfUrl); \
-    REGISTER_BENCHMARKS(GperfMac); \
-    REGISTER_BENCHMARKS(GperfCPF); \
-    REGISTER_BENCHMARKS(GperfSSN); \
-    REGISTER_BENCHMARKS(GperfIPV4); \
-    REGISTER_BENCHMARKS(GperfIPV6); \
-    REGISTER_BENCHMARKS(GperfINTS); \
-    REGISTER_BENCHMARKS(PextMurmurUrlComplex); \
-    REGISTER_BENCHMARKS(PextMurmurINTS);
+    FOR_ALL_HASHES(REGISTER_BENCHMARKS) \
+    FOR_ALL_HASHES(REGISTER_ABSL_MIXED_BENCHMARKS) \
+    benchmarks.push_back(DECLARE_ONE_BENCH(AdaptiveMapBench, AdaptivePextHash));
+
+/**
+ * @def REGISTER_ALL_MONITORED_BENCHMARKS
+ * @brief This macro registers the collision monitored benchmarks for all hash functions.
+ */
+#define REGISTER_ALL_MONITORED_BENCHMARKS \
+    FOR_ALL_HASHES(REGISTER_MONITORED_BENCHMARKS)
+
+/**
+ * @def REGISTER_ALL_SAMPLING_BENCHMARKS
+ * @brief This macro registers the sampling benchmarks for all hash functions.
+ */
+#define REGISTER_ALL_SAMPLING_BENCHMARKS \
+    FOR_ALL_HASHES(REGISTER_SAMPLING_BENCHMARKS)
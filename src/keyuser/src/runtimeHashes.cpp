@@ -0,0 +1,587 @@
+/**
+ * @file runtimeHashes.cpp
+ * @brief Implementation of the hash functions driven by layout tables.
+ *
+ * The loads are kept in a fixed-size table and the loop over them is unrolled at compile time, so the only difference
+ * from the compiled Pext functions is that masks and offsets come from memory instead of immediates.
+**/
+
+#if defined(__amd64__)  || \
+    defined(__amd64)    || \
+    defined(__x86_64__) || \
+    defined(__x86_64)   || \
+    defined(_M_X64)     || \
+    defined(_M_AMD64)
+    #define x86_64
+#elif defined(__arm64__) || \
+    defined(__arm64)     || \
+    defined(__aarch64__) || \
+    defined(__aarch64)
+    #define ARM
+#else
+    #error "ARCHITECTURE NOT SUPPORTED"
+#endif
+
+#if defined(x86_64)
+    #include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "runtimeHashes.hpp"
+#include "google-hashes/city.hpp"
+
+inline static uint64_t load_u64_le(const char* b) {
+    uint64_t Ret;
+    // This is a way for the compiler to optimize this func to a single movq instruction
+    memcpy(&Ret, b, sizeof(uint64_t));
+    return Ret;
+}
+
+inline static std::size_t pext_load(const char* key, const PextLoad& load) {
+#ifdef x86_64
+    return _pext_u64(load_u64_le(key + load.offset), load.mask);
+#elif defined(ARM)
+    return load_u64_le(key + load.offset) ^ load.mask;
+#endif
+}
+
+bool readPextLayout(const std::string& path, PextLayout& layout){
+    std::ifstream file(path);
+    std::string header;
+    std::size_t numLoads = 0;
+    if(!(file >> header >> layout.keySize >> numLoads) || header != "sepe-layout"){
+        return false;
+    }
+
+    layout.loads.clear();
+    for(std::size_t i = 0; i < numLoads; i++){
+        PextLoad load;
+        if(!(file >> load.offset >> std::hex >> load.mask >> std::dec >> load.shift)){
+            return false;
+        }
+        // Every load must be inside the key, otherwise we would read out of bounds
+        if(load.offset + sizeof(uint64_t) > layout.keySize || load.shift >= 64){
+            return false;
+        }
+        layout.loads.push_back(load);
+    }
+    return !layout.loads.empty();
+}
+
+// Widens a character to the start of its class, like keybuilder's print_class
+static char classStart(const char ch){
+    if (ch >= '0' && ch <= '9')
+        return '0';
+    if (ch >= 'A' && ch <= 'Z')
+        return 'A';
+    if (ch >= 'a' && ch <= 'z')
+        return 'a';
+    return '!';
+}
+
+// Widens a character to the end of its class, like keybuilder's print_class
+static char classEnd(const char ch){
+    if (ch >= '0' && ch <= '9')
+        return '9';
+    if (ch >= 'A' && ch <= 'Z')
+        return 'Z';
+    if (ch >= 'a' && ch <= 'z')
+        return 'z';
+    return '}';
+}
+
+bool inferPextLayout(const std::vector<std::string>& keys, PextLayout& layout){
+    if(keys.empty() || keys.front().size() < sizeof(uint64_t)){
+        return false;
+    }
+    const std::size_t keySize = keys.front().size();
+
+    // Per position character ranges, exactly as keybuilder infers them
+    std::vector<char> start(keys.front().begin(), keys.front().end());
+    std::vector<char> end(keys.front().begin(), keys.front().end());
+    for(const auto& key : keys){
+        if(key.size() != keySize){
+            return false;
+        }
+        for(std::size_t i = 0; i < keySize; i++){
+            start[i] = key[i] < start[i] ? key[i] : start[i];
+            end[i] = key[i] > end[i] ? key[i] : end[i];
+        }
+    }
+
+    // Per position masks, exactly as keysynth's Range calculates them
+    std::vector<uint8_t> masks(keySize, 0);
+    for(std::size_t i = 0; i < keySize; i++){
+        if(start[i] == end[i]){
+            continue;
+        }
+        const char classFirst = classStart(start[i]);
+        const char classLast = classEnd(end[i]);
+        uint8_t zeroes = 0;
+        uint8_t ones = classFirst;
+        for(char ch = classFirst; ch < classLast; ch++){
+            zeroes |= ch;
+            ones &= ch;
+        }
+        masks[i] = zeroes & ~ones;
+    }
+
+    // Guard words, as keysynth's guarded hash functions: the bits outside the masks are the same in every key
+    layout.guards.clear();
+    for(std::size_t offset = 0; offset < keySize; offset += sizeof(uint64_t)){
+        PextGuard guard;
+        guard.offset = offset + sizeof(uint64_t) > keySize ? keySize - sizeof(uint64_t) : offset;
+        for(std::size_t byte = 0; byte < sizeof(uint64_t); byte++){
+            const uint8_t fixed = ~masks[guard.offset + byte];
+            guard.fixed |= (std::size_t)fixed << (8 * byte);
+            guard.value |= (std::size_t)(keys.front()[guard.offset + byte] & fixed) << (8 * byte);
+        }
+        if(guard.fixed != 0){
+            layout.guards.push_back(guard);
+        }
+    }
+
+    // Pack variable bytes into 8 bytes loads. The last load is moved back into the key,
+    // and the bytes it shares with the previous load are masked out
+    layout.keySize = keySize;
+    layout.loads.clear();
+    std::size_t pos = 0;
+    while(pos < keySize){
+        if(masks[pos] == 0){
+            pos++;
+            continue;
+        }
+        PextLoad load;
+        load.offset = pos + sizeof(uint64_t) > keySize ? keySize - sizeof(uint64_t) : pos;
+        for(std::size_t byte = 0; byte < sizeof(uint64_t); byte++){
+            if(load.offset + byte >= pos){
+                load.mask |= (std::size_t)masks[load.offset + byte] << (8 * byte);
+            }
+        }
+        // Left shift every other load as much as possible for better collision
+        if(layout.loads.size() % 2 == 1){
+            load.shift = 64 - __builtin_popcountll(load.mask);
+        }
+        layout.loads.push_back(load);
+        pos = load.offset + sizeof(uint64_t);
+    }
+    return !layout.loads.empty() && layout.loads.size() <= MAX_RUNTIME_LOADS && layout.guards.size() <= MAX_RUNTIME_GUARDS;
+}
+
+AdaptivePextHash::AdaptivePextHash(const PextLayout& layout) :
+    numLoads(layout.loads.size()),
+    keySize(layout.keySize),
+    numGuards(layout.guards.size())
+{
+    for(std::size_t i = 0; i < numLoads; i++){
+        table[i] = layout.loads[i];
+    }
+    for(std::size_t i = 0; i < numGuards; i++){
+        guards[i] = layout.guards[i];
+    }
+}
+
+std::size_t AdaptivePextHash::operator()(const std::string& key) const {
+    // Conformance check: keys of other sizes would make the loads go out of bounds
+    if(numLoads == 0 || key.size() != keySize){
+        return CityHash64(key.c_str(), key.size());
+    }
+    // Keys that differ from the sample outside the masks would collide with the keys that only differ there
+    std::size_t differences = 0;
+    for(std::size_t i = 0; i < numGuards; i++){
+        differences |= (load_u64_le(key.c_str() + guards[i].offset) & guards[i].fixed) ^ guards[i].value;
+    }
+    if(differences != 0){
+        return CityHash64(key.c_str(), key.size());
+    }
+    std::size_t hash = 0;
+    for(std::size_t i = 0; i < numLoads; i++){
+        hash ^= pext_load(key.c_str(), table[i]) << table[i].shift;
+    }
+    return hash;
+}
+
+// Seed of the family hash functions, exactly as keysynth's familySeed
+static std::size_t family_seed(std::size_t hashID, std::size_t slot){
+    std::size_t z = (hashID * 64 + slot + 1) * 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return (z ^ (z >> 31)) | (1ul << 63);
+}
+
+RuntimePextFamily::RuntimePextFamily(const PextLayout& layout) :
+    numLoads(layout.loads.size())
+{
+    for(std::size_t i = 0; i < numLoads; i++){
+        table[i] = layout.loads[i];
+    }
+}
+
+std::size_t RuntimePextFamily::operator()(const std::string& key, std::size_t hashID) const {
+    std::size_t hash = 0;
+    for(std::size_t slot = 0; slot < numLoads; slot += 2){
+        const std::size_t first = pext_load(key.c_str(), table[slot]) ^ family_seed(hashID, slot);
+        const std::size_t second = slot + 1 < numLoads ? pext_load(key.c_str(), table[slot + 1]) ^ family_seed(hashID, slot + 1)
+                                                       : family_seed(hashID, slot + 1);
+        const __uint128_t product = (__uint128_t)first * second;
+        hash ^= (std::size_t)product ^ (std::size_t)(product >> 64);
+    }
+    return hash;
+}
+
+// Extracts the bits of `value` selected by `mask`, keeping their order, like PEXT does
+inline static std::size_t extract_bits(std::size_t value, std::size_t mask) {
+#ifdef x86_64
+    return _pext_u64(value, mask);
+#elif defined(ARM)
+    std::size_t extracted = 0;
+    for(std::size_t bit = 1; mask != 0; mask &= mask - 1, bit <<= 1){
+        if(value & mask & -mask){
+            extracted |= bit;
+        }
+    }
+    return extracted;
+#endif
+}
+
+RuntimeSortKey::RuntimeSortKey(const PextLayout& layout) :
+    numLoads(layout.loads.size())
+{
+    for(std::size_t i = 0; i < numLoads; i++){
+        table[i].offset = layout.loads[i].offset;
+        table[i].mask = __builtin_bswap64(layout.loads[i].mask);
+        table[i].shift = __builtin_popcountll(layout.loads[i].mask);
+        bits += table[i].shift;
+    }
+}
+
+__uint128_t RuntimeSortKey::operator()(const std::string& key) const {
+    __uint128_t sortKey = 0;
+    for(std::size_t i = 0; i < numLoads; i++){
+        const std::size_t load = __builtin_bswap64(load_u64_le(key.c_str() + table[i].offset));
+        sortKey = (sortKey << table[i].shift) | extract_bits(load, table[i].mask);
+    }
+    return sortKey;
+}
+
+// Entropy of the values of a few bits across a sample of keys, counts is a zeroed histogram left zeroed
+static double sample_entropy(const std::vector<uint32_t>& values, std::vector<uint32_t>& counts){
+    for(uint32_t value : values){
+        counts[value]++;
+    }
+    double entropy = 0.0;
+    for(uint32_t value : values){
+        if(counts[value] != 0){
+            const double p = (double)counts[value] / values.size();
+            entropy -= p * std::log2(p);
+            counts[value] = 0;
+        }
+    }
+    return entropy;
+}
+
+RuntimePartition::RuntimePartition(const PextLayout& layout, unsigned k, const std::vector<std::string>& keys){
+    if(layout.loads.empty()){
+        return;
+    }
+
+    // Bits of the key in the loads the hash function does not shift, which end up in its least significant bits
+    std::vector<bool> lowBits(8 * (layout.keySize + sizeof(uint64_t)), false);
+    for(std::size_t i = 0; i < layout.loads.size() && layout.loads.size() > 1; i += 2){
+        for(std::size_t bit = 0; bit < 64; bit++){
+            if((layout.loads[i].mask >> bit) & 1){
+                lowBits[8 * layout.loads[i].offset + bit] = true;
+            }
+        }
+    }
+
+    // Evenly spaced sample of the keys that are long enough for the layout
+    std::vector<const std::string*> sample;
+    const std::size_t stride = keys.size() / MAX_PARTITION_SAMPLE + 1;
+    for(std::size_t i = 0; i < keys.size(); i += stride){
+        if(keys[i].size() >= layout.keySize){
+            sample.push_back(&keys[i]);
+        }
+    }
+
+    // Candidate bits of every load shifted to the most significant bits, or of the only load
+    std::vector<std::size_t> chosenBits;
+    double chosenEntropy = -1.0;
+    const std::size_t firstShifted = layout.loads.size() > 1 ? 1 : 0;
+    std::vector<uint32_t> values(sample.size());
+    std::vector<uint32_t> counts(1 << 16, 0);
+    for(std::size_t i = firstShifted; i < layout.loads.size(); i += 2){
+        std::vector<std::size_t> candidates;
+        double loadEntropy = 0.0;
+        for(int bit = 0; bit < 8; bit++){
+            for(int byte = 7; byte >= 0; byte--){
+                const std::size_t bitIndex = 8 * byte + bit;
+                if(!((layout.loads[i].mask >> bitIndex) & 1) || lowBits[8 * layout.loads[i].offset + bitIndex]){
+                    continue;
+                }
+                candidates.push_back(bitIndex);
+                for(std::size_t j = 0; j < sample.size(); j++){
+                    values[j] = (load_u64_le(sample[j]->c_str() + layout.loads[i].offset) >> bitIndex) & 1;
+                }
+                loadEntropy += sample_entropy(values, counts);
+            }
+        }
+        if(!candidates.empty() && loadEntropy / candidates.size() > chosenEntropy){
+            load.offset = layout.loads[i].offset;
+            chosenBits = candidates;
+            chosenEntropy = loadEntropy / candidates.size();
+        }
+    }
+
+    // Greedy ranking by the joint entropy of the bits taken so far
+    std::vector<uint32_t> taken(sample.size(), 0);
+    for(; bits < k && !chosenBits.empty(); bits++){
+        std::size_t best = 0;
+        double bestEntropy = -1.0;
+        for(std::size_t c = 0; c < chosenBits.size(); c++){
+            for(std::size_t j = 0; j < sample.size(); j++){
+                const std::size_t word = load_u64_le(sample[j]->c_str() + load.offset);
+                values[j] = (taken[j] << 1) | ((word >> chosenBits[c]) & 1);
+            }
+            const double entropy = sample_entropy(values, counts);
+            if(entropy > bestEntropy){
+                best = c;
+                bestEntropy = entropy;
+            }
+        }
+        for(std::size_t j = 0; j < sample.size(); j++){
+            const std::size_t word = load_u64_le(sample[j]->c_str() + load.offset);
+            taken[j] = (taken[j] << 1) | ((word >> chosenBits[best]) & 1);
+        }
+        load.mask |= 1ul << chosenBits[best];
+        chosenBits.erase(chosenBits.begin() + best);
+    }
+}
+
+std::size_t RuntimePartition::operator()(const std::string& key) const {
+    return extract_bits(load_u64_le(key.c_str() + load.offset), load.mask);
+}
+
+RuntimePaddedPextHash::RuntimePaddedPextHash(const PextLayout& layout) :
+    numLoads(layout.loads.size())
+{
+    for(std::size_t i = 0; i < numLoads; i++){
+        table[i] = layout.loads[i];
+    }
+}
+
+std::size_t RuntimePaddedPextHash::operator()(const char* key) const {
+    std::size_t hash = 0;
+    for(std::size_t i = 0; i < numLoads; i++){
+        hash ^= pext_load(key, table[i]) << table[i].shift;
+    }
+    return hash;
+}
+
+PextLayout padPextLayout(const PextLayout& layout){
+    // Mask of every byte of the key, the bytes shared by overlapping loads are in both masks
+    std::vector<uint8_t> masks(layout.keySize + sizeof(uint64_t), 0);
+    for(const auto& load : layout.loads){
+        for(std::size_t byte = 0; byte < sizeof(uint64_t); byte++){
+            masks[load.offset + byte] |= load.mask >> (8 * byte);
+        }
+    }
+
+    // Fixed stride from every variable byte that starts a load, exactly as keysynth's calculatePaddedOffsets
+    PextLayout padded;
+    padded.keySize = layout.keySize;
+    std::size_t offset = 0;
+    while(offset < layout.keySize){
+        if(masks[offset] == 0){
+            offset++;
+            continue;
+        }
+        PextLoad load;
+        load.offset = offset;
+        for(std::size_t byte = 0; byte < sizeof(uint64_t); byte++){
+            load.mask |= (std::size_t)masks[offset + byte] << (8 * byte);
+        }
+        // Left shift every other load as much as possible for better collision
+        if(padded.loads.size() % 2 == 1){
+            load.shift = 64 - __builtin_popcountll(load.mask);
+        }
+        padded.loads.push_back(load);
+        offset += sizeof(uint64_t);
+    }
+    return padded;
+}
+
+const char* findField(const char* record, std::size_t recordSize, std::size_t fieldIndex, char delimiter){
+    std::size_t pos = 0;
+    std::size_t remaining = fieldIndex;
+#ifdef x86_64
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+    for(; remaining > 0 && pos + 16 <= recordSize; pos += 16){
+        const __m128i chars = _mm_loadu_si128((const __m128i *)(record + pos));
+        unsigned found = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, delimiters));
+        const std::size_t count = __builtin_popcount(found);
+        if(count >= remaining){
+            for(; remaining > 1; remaining--){
+                found &= found - 1;
+            }
+            return record + pos + __builtin_ctz(found) + 1;
+        }
+        remaining -= count;
+    }
+#endif
+    for(; remaining > 0 && pos < recordSize; pos++){
+        remaining -= record[pos] == delimiter;
+    }
+    return remaining == 0 ? record + pos : nullptr;
+}
+
+// Mixer of the minimal perfect hash function, exactly as keysynth's mphMix
+static std::size_t mph_mix(std::size_t x){
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53;
+    x ^= x >> 33;
+    return x;
+}
+
+// Maps x to [0, n) without a division
+static std::size_t mph_range(std::size_t x, std::size_t n){
+    return ((__uint128_t)x * n) >> 64;
+}
+
+// Position of a key, given its mixed first-level hash and the pilot of its bucket
+static std::size_t mph_position(std::size_t mixed, std::size_t pilot, std::size_t numKeys){
+    return mph_range(mph_mix(mixed ^ (pilot * 0x9e3779b97f4a7c15)), numKeys);
+}
+
+bool buildMinimalPerfectHash(const PextLayout& layout, std::vector<std::string> keys, RuntimeMinimalPerfectHash& mph){
+    // Same limits as keysynth's MPH_BUCKET_FACTOR and MPH_MAX_PILOT
+    constexpr double bucketFactor = 6.0;
+    constexpr std::size_t maxPilot = 1 << 24;
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    mph.firstLevel = AdaptivePextHash(layout);
+    mph.numKeys = keys.size();
+    mph.numBuckets = std::max<std::size_t>(1, std::ceil(bucketFactor * mph.numKeys / std::max(1.0, std::log2(mph.numKeys))));
+
+    std::vector<std::size_t> hashes;
+    hashes.reserve(keys.size());
+    for(const auto& key : keys){
+        hashes.push_back(mph.firstLevel(key));
+    }
+    std::sort(hashes.begin(), hashes.end());
+    if(std::adjacent_find(hashes.begin(), hashes.end()) != hashes.end()){
+        return false;
+    }
+
+    std::vector<std::vector<std::size_t>> buckets(mph.numBuckets);
+    for(const auto& hash : hashes){
+        const std::size_t mixed = mph_mix(hash);
+        buckets[mph_range(mixed, mph.numBuckets)].push_back(mixed);
+    }
+    std::vector<std::size_t> order(mph.numBuckets);
+    for(std::size_t i = 0; i < mph.numBuckets; i++){
+        order[i] = i;
+    }
+    // Largest buckets first, while most positions are still free
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){ return buckets[a].size() > buckets[b].size(); });
+
+    std::vector<uint32_t> pilots(mph.numBuckets, 0);
+    std::vector<bool> taken(mph.numKeys, false);
+    std::vector<std::size_t> positions;
+    for(const auto& bucketID : order){
+        const std::vector<std::size_t>& bucket = buckets[bucketID];
+        if(bucket.empty()){
+            break;
+        }
+        std::size_t pilot = 0;
+        for(; pilot < maxPilot; pilot++){
+            positions.clear();
+            for(const auto& mixed : bucket){
+                const std::size_t position = mph_position(mixed, pilot, mph.numKeys);
+                if(taken[position] || std::find(positions.begin(), positions.end(), position) != positions.end()){
+                    break;
+                }
+                positions.push_back(position);
+            }
+            if(positions.size() == bucket.size()){
+                break;
+            }
+        }
+        if(pilot == maxPilot){
+            return false;
+        }
+        for(const auto& position : positions){
+            taken[position] = true;
+        }
+        pilots[bucketID] = pilot;
+    }
+    mph.ownedPilots = std::make_shared<const std::vector<uint32_t>>(std::move(pilots));
+    mph.pilots = mph.ownedPilots->data();
+    return true;
+}
+
+std::size_t RuntimeMinimalPerfectHash::operator()(const std::string& key) const {
+    const std::size_t mixed = mph_mix(firstLevel(key));
+    return mph_position(mixed, pilots[mph_range(mixed, numBuckets)], numKeys);
+}
+
+template <std::size_t N>
+RuntimePextHash<N>::RuntimePextHash(const PextLayout& layout){
+    for(std::size_t i = 0; i < N; i++){
+        table[i] = layout.loads[i];
+    }
+}
+
+template <std::size_t N>
+std::size_t RuntimePextHash<N>::operator()(const std::string& key) const {
+    const char* ptr = key.c_str();
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return ((pext_load(ptr, table[I]) << table[I].shift) ^ ...);
+    }(std::make_index_sequence<N>{});
+}
+
+template <std::size_t N>
+RuntimeOffXorHash<N>::RuntimeOffXorHash(const PextLayout& layout){
+    for(std::size_t i = 0; i < N; i++){
+        table[i] = layout.loads[i];
+    }
+}
+
+template <std::size_t N>
+std::size_t RuntimeOffXorHash<N>::operator()(const std::string& key) const {
+    const char* ptr = key.c_str();
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+        return (load_u64_le(ptr + table[I].offset) ^ ...);
+    }(std::make_index_sequence<N>{});
+}
+
+// Instantiate every supported number of loads
+#define INSTANTIATE_RUNTIME_HASHES(N) \
+    template struct RuntimePextHash<N>; \
+    template struct RuntimeOffXorHash<N>;
+
+INSTANTIATE_RUNTIME_HASHES(1)
+INSTANTIATE_RUNTIME_HASHES(2)
+INSTANTIATE_RUNTIME_HASHES(3)
+INSTANTIATE_RUNTIME_HASHES(4)
+INSTANTIATE_RUNTIME_HASHES(5)
+INSTANTIATE_RUNTIME_HASHES(6)
+INSTANTIATE_RUNTIME_HASHES(7)
+INSTANTIATE_RUNTIME_HASHES(8)
+INSTANTIATE_RUNTIME_HASHES(9)
+INSTANTIATE_RUNTIME_HASHES(10)
+INSTANTIATE_RUNTIME_HASHES(11)
+INSTANTIATE_RUNTIME_HASHES(12)
+INSTANTIATE_RUNTIME_HASHES(13)
+INSTANTIATE_RUNTIME_HASHES(14)
+INSTANTIATE_RUNTIME_HASHES(15)
+INSTANTIATE_RUNTIME_HASHES(16)
@@ -0,0 +1,347 @@
+/**
+ * @file runtimeHashes.hpp
+ * @brief This file contains hash functions whose masks and offsets are only known at runtime.
+ *
+ * The custom hash functions in customHashes.hpp are compiled with constexpr masks. The functions in this file read the
+ * same information from a layout table synthesized by `keysynth --layout`, so a new key format only needs a new table.
+ */
+
+#ifndef RUNTIME_HASHES_HPP
+#define RUNTIME_HASHES_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Maximum number of loads supported by the runtime hash functions.
+ */
+constexpr std::size_t MAX_RUNTIME_LOADS = 16;
+
+/**
+ * @brief A single 8 bytes load of a synthesized hash function.
+ */
+struct PextLoad{
+    std::size_t offset = 0; ///< Offset of the load in the key.
+    std::size_t mask = 0; ///< PEXT mask applied to the load.
+    unsigned shift = 0; ///< Left shift applied to the compressed load.
+};
+
+/**
+ * @brief Maximum number of guard words of an inferred layout, enough for keys of 128 bytes.
+ */
+constexpr std::size_t MAX_RUNTIME_GUARDS = 16;
+
+/**
+ * @brief An 8 bytes word of the key whose bits outside the PEXT masks were the same in every sampled key.
+ */
+struct PextGuard{
+    std::size_t offset = 0; ///< Offset of the word in the key.
+    std::size_t fixed = 0; ///< Bits of the word that were the same in every sampled key.
+    std::size_t value = 0; ///< Value of the fixed bits.
+};
+
+/**
+ * @brief Layout of a synthesized hash function, as printed by `keysynth --layout`.
+ */
+struct PextLayout{
+    std::size_t keySize = 0; ///< Size of the keys the layout was synthesized for.
+    std::vector<PextLoad> loads; ///< Loads of the hash function.
+    std::vector<PextGuard> guards; ///< Guard words of an inferred layout. Empty for layouts read from a file.
+};
+
+/**
+ * @brief Reads a layout table synthesized by `keysynth --layout`.
+ *
+ * @param path The path of the layout file.
+ * @param layout The layout to fill.
+ * @return true If the file was read and is a valid layout.
+ * @return false Otherwise.
+ */
+bool readPextLayout(const std::string& path, PextLayout& layout);
+
+/**
+ * @brief Pext hash function driven by a layout table.
+ *
+ * @tparam N The number of loads of the layout, so the loop over the table is fully unrolled.
+ */
+template <std::size_t N>
+struct RuntimePextHash{
+    std::array<PextLoad, N> table{}; ///< The loads of the hash function.
+
+    RuntimePextHash() = default;
+
+    /**
+     * @brief Construct a new Runtime Pext Hash object.
+     *
+     * @param layout The layout to copy the loads from. Must have exactly N loads.
+     */
+    explicit RuntimePextHash(const PextLayout& layout);
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key The fixed lenght std::string key to hash.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key) const;
+};
+
+/**
+ * @brief OffXor hash function driven by a layout table. Masks and shifts are ignored.
+ *
+ * @tparam N The number of loads of the layout, so the loop over the table is fully unrolled.
+ */
+template <std::size_t N>
+struct RuntimeOffXorHash{
+    std::array<PextLoad, N> table{}; ///< The loads of the hash function.
+
+    RuntimeOffXorHash() = default;
+
+    /**
+     * @brief Construct a new Runtime OffXor Hash object.
+     *
+     * @param layout The layout to copy the loads from. Must have exactly N loads.
+     */
+    explicit RuntimeOffXorHash(const PextLayout& layout);
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key The fixed lenght std::string key to hash.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key) const;
+};
+
+/**
+ * @brief Family of independent hash functions driven by a layout table, the runtime version of `keysynth --family`.
+ *
+ * Every function XORs the compressed loads with its own seeds, and multiplies pairs of them into 128 bits, folding the
+ * high and the low halves. The seeds are the same ones keysynth synthesizes.
+ */
+struct RuntimePextFamily{
+    std::array<PextLoad, MAX_RUNTIME_LOADS> table{}; ///< The loads of the hash functions.
+    std::size_t numLoads = 0; ///< Number of valid loads in the table.
+
+    /**
+     * @brief Construct a new Runtime Pext Family object.
+     *
+     * @param layout The layout to copy the loads from. Must have at most MAX_RUNTIME_LOADS loads.
+     */
+    explicit RuntimePextFamily(const PextLayout& layout);
+
+    /**
+     * @brief Calculates the hash of a key with one function of the family.
+     *
+     * @param key The fixed lenght std::string key to hash.
+     * @param hashID The index of the hash function in the family.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key, std::size_t hashID) const;
+};
+
+/**
+ * @brief Order-preserving sort key driven by a layout table, the runtime version of `keysynth --sort-key`.
+ *
+ * Every load is converted to big-endian and compressed, and the compressed loads are concatenated in key order. Since
+ * the bits dropped by the masks are the same in every key, sort keys compare in the same order as the keys themselves.
+ */
+struct RuntimeSortKey{
+    std::array<PextLoad, MAX_RUNTIME_LOADS> table{}; ///< The loads, with big-endian masks and shifts of their bit counts.
+    std::size_t numLoads = 0; ///< Number of valid loads in the table.
+    unsigned bits = 0; ///< Total number of bits of the sort key.
+
+    /**
+     * @brief Construct a new Runtime Sort Key object.
+     *
+     * @param layout The layout to copy the loads from. Must have at most MAX_RUNTIME_LOADS loads, in key order.
+     */
+    explicit RuntimeSortKey(const PextLayout& layout);
+
+    /**
+     * @brief Function call operator that calculates the sort key of a key.
+     *
+     * @param key The fixed lenght std::string key.
+     * @return The sort key of the key. Only meaningful if `bits` is at most 128.
+     */
+    __uint128_t operator()(const std::string& key) const;
+};
+
+/**
+ * @brief Maximum number of keys sampled to rank the partition bits.
+ */
+constexpr std::size_t MAX_PARTITION_SAMPLE = 1 << 16;
+
+/**
+ * @brief Partition function driven by a layout table, the runtime version of `keysynth --partition`.
+ *
+ * It extracts k bits of a load that the Pext hash function shifts to its most significant bits, so the hash tables of
+ * each partition still tell their keys apart, leaving out the bits that overlapping loads also feed into the least
+ * significant bits of the hash. The load with the most entropy per bit over a sample of the keys is chosen, and its
+ * bits are taken greedily, each one maximizing the joint entropy of the bits taken so far over the sample, so the
+ * partitions are as even as possible. Ties keep the lowest bit of every byte first, starting from the last bytes of
+ * the load.
+ */
+struct RuntimePartition{
+    PextLoad load; ///< The load the partition bits are extracted from.
+    unsigned bits = 0; ///< Number of partition bits, which may be less than requested if the load has fewer bits.
+
+    /**
+     * @brief Construct a new Runtime Partition object.
+     *
+     * @param layout The layout to choose the load from.
+     * @param k The number of partition bits, for 2^k partitions. At most 16.
+     * @param keys The keys to sample, of the layout's size. If empty, bits are taken in the order of ties.
+     */
+    RuntimePartition(const PextLayout& layout, unsigned k, const std::vector<std::string>& keys);
+
+    /**
+     * @brief Function call operator that calculates the partition of a key.
+     *
+     * @param key The fixed lenght std::string key.
+     * @return The partition of the key, smaller than 2^bits.
+     */
+    std::size_t operator()(const std::string& key) const;
+};
+
+/**
+ * @brief Pext hash function of keys that are followed by readable padding, the runtime version of `keysynth --padded`.
+ *
+ * Unlike the other runtime hash functions, it takes a pointer to the key, since its loads may read past the end of the
+ * key. It works with any layout, so the loads of padPextLayout can be compared with the clamped ones.
+ */
+struct RuntimePaddedPextHash{
+    std::array<PextLoad, MAX_RUNTIME_LOADS> table{}; ///< The loads of the hash function.
+    std::size_t numLoads = 0; ///< Number of valid loads in the table.
+
+    /**
+     * @brief Construct a new Runtime Padded Pext Hash object.
+     *
+     * @param layout The layout to copy the loads from. Must have at most MAX_RUNTIME_LOADS loads.
+     */
+    explicit RuntimePaddedPextHash(const PextLayout& layout);
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key Pointer to the key, followed by at least 8 readable bytes.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const char* key) const;
+};
+
+/**
+ * @brief Converts a layout into the loads of padded keys, as `keysynth --padded` calculates them.
+ *
+ * The layouts of keysynth move the last load back into the key, so it overlaps the previous one and needs its own mask.
+ * Padded loads have a fixed stride from the first variable byte and are never moved back, so the last one reads up to
+ * 7 bytes past the end of the key, which are outside its mask.
+ *
+ * @param layout The layout to convert.
+ * @return PextLayout The padded layout.
+ */
+PextLayout padPextLayout(const PextLayout& layout);
+
+/**
+ * @brief Finds the start of a field in a delimited record, the runtime version of the find_field of
+ * `keysynth --embedded`.
+ *
+ * The delimiters are counted 16 bytes at a time, with SSE2 compares and popcount on x86.
+ *
+ * @param record Pointer to the record, such as a CSV row.
+ * @param recordSize Size of the record.
+ * @param fieldIndex Index of the field, the number of delimiters before it.
+ * @param delimiter The delimiter of the fields.
+ * @return const char* The first byte of the field, or nullptr if the record has fewer delimiters.
+ */
+const char* findField(const char* record, std::size_t recordSize, std::size_t fieldIndex, char delimiter);
+
+/**
+ * @brief Infers a Pext layout from a sample of keys, in the same way keybuilder and keysynth would.
+ *
+ * Every position is widened to its character class ([0-9], [A-Z], [a-z], or [!-}]), and its mask keeps the bits that
+ * change across the class. The variable bytes are then packed into as few 8 bytes loads as possible.
+ *
+ * The bits outside the masks, which were the same in every sampled key, are also recorded as guard words, so keys that
+ * differ there can be told apart from the keys the layout was inferred from.
+ *
+ * @param keys The sample of keys. All keys must have the same size, of at least 8 bytes.
+ * @param layout The layout to fill.
+ * @return true If a layout with at most MAX_RUNTIME_LOADS loads and MAX_RUNTIME_GUARDS guard words was inferred.
+ * @return false Otherwise.
+ */
+bool inferPextLayout(const std::vector<std::string>& keys, PextLayout& layout);
+
+/**
+ * @brief Pext hash function whose layout may be replaced at runtime.
+ *
+ * Without a layout, or for keys that do not conform to it, it falls back to CityHash. Keys conform if they have the
+ * layout's size, and if their guard words have the bits fixed in the sampled keys, like the guarded hash functions of
+ * keysynth. Otherwise, keys that only differ in positions that were constant in the sample would all collide.
+ */
+struct AdaptivePextHash{
+    std::array<PextLoad, MAX_RUNTIME_LOADS> table{}; ///< The loads of the hash function.
+    std::size_t numLoads = 0; ///< Number of valid loads in the table. Zero means CityHash is used.
+    std::size_t keySize = 0; ///< Size of the keys the layout was synthesized for.
+    std::array<PextGuard, MAX_RUNTIME_GUARDS> guards{}; ///< The guard words of the layout.
+    std::size_t numGuards = 0; ///< Number of valid guard words. Zero means only the key size is checked.
+
+    AdaptivePextHash() = default;
+
+    /**
+     * @brief Construct a new Adaptive Pext Hash object.
+     *
+     * @param layout The layout to copy the loads and guard words from. Must have at most MAX_RUNTIME_LOADS loads and
+     *               MAX_RUNTIME_GUARDS guard words.
+     */
+    explicit AdaptivePextHash(const PextLayout& layout);
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key The std::string key to hash.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key) const;
+};
+
+/**
+ * @brief Minimal perfect hash function of a closed set of keys, the runtime version of `keysynth --mph`.
+ *
+ * The Pext hash function of the layout is the first level. Its hash is mixed to pick a bucket, and mixed again with the
+ * bucket's pilot to pick the position of the key among [0, numKeys). The pilots are searched exactly as keysynth does,
+ * so both produce the same positions.
+ */
+struct RuntimeMinimalPerfectHash{
+    AdaptivePextHash firstLevel; ///< The Pext hash function of the layout.
+    std::shared_ptr<const std::vector<uint32_t>> ownedPilots; ///< Storage of the pilots, shared between the copies. May be null.
+    const uint32_t* pilots = nullptr; ///< The pilot of every bucket, in ownedPilots or in memory owned by someone else.
+    std::size_t numKeys = 0; ///< Number of keys, and of positions.
+    std::size_t numBuckets = 0; ///< Number of buckets.
+
+    RuntimeMinimalPerfectHash() = default;
+
+    /**
+     * @brief Function call operator that calculates the position of a key.
+     *
+     * @param key The fixed lenght std::string key.
+     * @return The position of the key, smaller than numKeys. Keys outside the set get an arbitrary position.
+     */
+    std::size_t operator()(const std::string& key) const;
+};
+
+/**
+ * @brief Builds a minimal perfect hash function of a closed set of keys.
+ *
+ * @param layout The layout of the first-level Pext hash function. Must have at most MAX_RUNTIME_LOADS loads.
+ * @param keys The keys. Duplicated keys are ignored.
+ * @param mph The minimal perfect hash function to fill.
+ * @return true If the hash function was built.
+ * @return false If the Pext hash function collides on the keys, or no pilot places some bucket.
+ */
+bool buildMinimalPerfectHash(const PextLayout& layout, std::vector<std::string> keys, RuntimeMinimalPerfectHash& mph);
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file samplingHash.cpp
+ * @brief Implementation of the key sampler.
+**/
+
+#include <chrono>
+#include <cstring>
+
+#include "samplingHash.hpp"
+
+// How long the background thread sleeps between two drains, short enough that rings rarely fill up
+constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(10);
+
+void SampleRing::push(const std::string& key){
+    const std::size_t pushed = head.load(std::memory_order_relaxed);
+    if(pushed - tail.load(std::memory_order_acquire) == SAMPLE_RING_SIZE){
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Slot& slot = slots[pushed % SAMPLE_RING_SIZE];
+    slot.size = key.size() < MAX_SAMPLED_KEY_SIZE ? key.size() : MAX_SAMPLED_KEY_SIZE;
+    memcpy(slot.key, key.data(), slot.size);
+    head.store(pushed + 1, std::memory_order_release);
+}
+
+std::size_t SampleRing::drain(FILE* output){
+    const std::size_t popped = tail.load(std::memory_order_relaxed);
+    const std::size_t pushed = head.load(std::memory_order_acquire);
+    for(std::size_t i = popped; i < pushed; i++){
+        const Slot& slot = slots[i % SAMPLE_RING_SIZE];
+        fwrite(slot.key, 1, slot.size, output);
+        fputc('\n', output);
+    }
+    tail.store(pushed, std::memory_order_release);
+    return pushed - popped;
+}
+
+KeySampler& KeySampler::instance(){
+    static KeySampler sampler;
+    return sampler;
+}
+
+KeySampler::~KeySampler(){
+    stop();
+}
+
+void KeySampler::drainAll(){
+    std::lock_guard<std::mutex> guard(ringsLock);
+    for(auto& ring : rings){
+        written += ring->drain(output);
+    }
+}
+
+bool KeySampler::start(const std::string& path, std::size_t _period){
+    if(running || _period == 0){
+        return false;
+    }
+    output = fopen(path.c_str(), "w");
+    if(!output){
+        return false;
+    }
+    period = _period;
+    samplingCountdown = _period;
+    running = true;
+    drainer = std::thread([this](){
+        while(running.load(std::memory_order_relaxed)){
+            drainAll();
+            fflush(output);
+            std::this_thread::sleep_for(DRAIN_INTERVAL);
+        }
+    });
+    return true;
+}
+
+void KeySampler::stop(){
+    if(!running.exchange(false)){
+        return;
+    }
+    drainer.join();
+    drainAll();
+    fclose(output);
+    output = nullptr;
+}
+
+void KeySampler::sample(const std::string& key){
+    samplingCountdown = period.load(std::memory_order_relaxed);
+
+    // The first sample of a thread registers its ring, which lives as long as the sampler
+    thread_local SampleRing* ring = nullptr;
+    if(!ring){
+        std::lock_guard<std::mutex> guard(ringsLock);
+        rings.push_back(std::make_unique<SampleRing>());
+        ring = rings.back().get();
+    }
+    ring->push(key);
+}
+
+std::size_t KeySampler::samplesWritten(){
+    std::lock_guard<std::mutex> guard(ringsLock);
+    return written;
+}
+
+std::size_t KeySampler::samplesDropped(){
+    std::lock_guard<std::mutex> guard(ringsLock);
+    std::size_t dropped = 0;
+    for(const auto& ring : rings){
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
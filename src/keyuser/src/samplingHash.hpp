@@ -0,0 +1,164 @@
+/**
+ * @file samplingHash.hpp
+ * @brief This file contains a hash function wrapper that samples the keys it hashes, to profile them with keybuilder.
+ *
+ * Every thread counts down the keys it hashes, and once every `period` keys it copies the key into its own ring
+ * buffer. A background thread drains the rings of all threads into a sample file, one key per line, which keybuilder
+ * reads like any other file of keys. Unsampled keys only pay for the decrement of a thread-local counter and a branch
+ * that is almost never taken.
+ */
+
+#ifndef SAMPLING_HASH_HPP
+#define SAMPLING_HASH_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Default number of hashed keys between two samples of the same thread.
+ */
+constexpr std::size_t SAMPLING_PERIOD = 4096;
+
+/**
+ * @brief Number of sampled keys each ring buffer holds until the background thread drains it.
+ */
+constexpr std::size_t SAMPLE_RING_SIZE = 1024;
+
+/**
+ * @brief Maximum number of bytes kept of a sampled key. Longer keys are truncated.
+ */
+constexpr std::size_t MAX_SAMPLED_KEY_SIZE = 127;
+
+/**
+ * @brief Keys left before the next sample of the calling thread.
+ */
+inline thread_local std::size_t samplingCountdown = SAMPLING_PERIOD;
+
+/**
+ * @brief A ring buffer of sampled keys with a single producer, the thread that owns it, and a single consumer, the
+ * background thread. The producer only moves the head and the consumer only moves the tail, so no lock is needed.
+ */
+struct SampleRing{
+    /**
+     * @brief A sampled key, truncated to MAX_SAMPLED_KEY_SIZE bytes.
+     */
+    struct Slot{
+        unsigned char size; ///< Number of bytes of the key.
+        char key[MAX_SAMPLED_KEY_SIZE]; ///< The bytes of the key.
+    };
+
+    alignas(64) std::atomic<std::size_t> head{0}; ///< Number of keys pushed by the producer.
+    alignas(64) std::atomic<std::size_t> tail{0}; ///< Number of keys popped by the consumer.
+    std::atomic<std::size_t> dropped{0}; ///< Number of keys dropped because the ring was full.
+    std::array<Slot, SAMPLE_RING_SIZE> slots; ///< The sampled keys.
+
+    /**
+     * @brief Push a key, or drop it if the ring is full. Only called by the thread that owns the ring.
+     *
+     * @param key The key to push.
+     */
+    void push(const std::string& key);
+
+    /**
+     * @brief Pop every key pushed so far. Only called by the background thread.
+     *
+     * @param output The file to write the keys to, one per line.
+     * @return std::size_t The number of keys written.
+     */
+    std::size_t drain(FILE* output);
+};
+
+/**
+ * @brief The process-wide sampler, which owns the ring buffers and the background thread that drains them.
+ *
+ * Keys are sampled whether the sampler was started or not, but they are only written once it is. Until then, the
+ * rings fill up and the following samples are dropped.
+ */
+class KeySampler{
+    std::mutex ringsLock; ///< Protects the list of rings, which grows once per sampling thread.
+    std::vector<std::unique_ptr<SampleRing>> rings; ///< The rings of every thread that sampled a key.
+    std::atomic<std::size_t> period{SAMPLING_PERIOD}; ///< Number of hashed keys between two samples of a thread.
+    std::atomic<bool> running{false}; ///< Whether the background thread is draining the rings.
+    std::thread drainer; ///< The background thread.
+    FILE* output = nullptr; ///< The sample file.
+    std::size_t written = 0; ///< Number of keys written to the sample file.
+
+    /**
+     * @brief Drain every ring into the sample file.
+     */
+    void drainAll();
+
+    public:
+        /**
+         * @brief Get the sampler of the process.
+         */
+        static KeySampler& instance();
+
+        /**
+         * @brief Destroy the Key Sampler object, stopping the background thread.
+         */
+        ~KeySampler();
+
+        /**
+         * @brief Start the background thread, which drains the rings into a sample file every few milliseconds.
+         *
+         * @param path The path of the sample file, overwritten.
+         * @param _period Number of hashed keys between two samples of a thread.
+         * @return true If the sample file was opened.
+         * @return false Otherwise, or if the sampler was already started.
+         */
+        bool start(const std::string& path, std::size_t _period = SAMPLING_PERIOD);
+
+        /**
+         * @brief Stop the background thread, after writing the keys still in the rings, and close the sample file.
+         */
+        void stop();
+
+        /**
+         * @brief Sample a key into the ring of the calling thread, and restart its countdown.
+         *
+         * @param key The key to sample.
+         */
+        void sample(const std::string& key);
+
+        /**
+         * @brief Get the number of keys written to the sample file so far.
+         */
+        std::size_t samplesWritten();
+
+        /**
+         * @brief Get the number of keys dropped because a ring was full.
+         */
+        std::size_t samplesDropped();
+};
+
+/**
+ * @brief Hash function that forwards to another one, and samples one of every `period` keys it hashes in each thread.
+ *
+ * @tparam HashFuncT The type of the sampled hash function.
+ */
+template <typename HashFuncT>
+struct SamplingHash{
+    HashFuncT hash; ///< The sampled hash function object.
+
+    /**
+     * @brief Function call operator that calculates the hash of a key.
+     *
+     * @param key The std::string key to hash.
+     * @return The hash of the key.
+     */
+    std::size_t operator()(const std::string& key) const {
+        if(--samplingCountdown == 0) [[unlikely]] {
+            KeySampler::instance().sample(key);
+        }
+        return hash(key);
+    }
+};
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file staticIndex.cpp
+ * @brief Implementation of the memory mapped hash index.
+**/
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "staticIndex.hpp"
+
+static const char INDEX_MAGIC[8] = {'s', 'e', 'p', 'e', 'i', 'd', 'x', '1'};
+
+// Size of the key and value sizes at the beginning of every slot
+constexpr std::size_t SLOT_HEADER_SIZE = 2 * sizeof(uint16_t);
+
+static std::size_t roundUp(std::size_t value, std::size_t alignment){
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool buildStaticIndex(const PextLayout& layout,
+                      const std::vector<std::pair<std::string, std::string>>& entries,
+                      const std::string& path)
+{
+    std::vector<std::string> keys;
+    keys.reserve(entries.size());
+    std::size_t slotSize = 16;
+    for(const auto& [key, value] : entries){
+        if(key.size() > UINT16_MAX || value.size() > UINT16_MAX){
+            return false;
+        }
+        while(slotSize < SLOT_HEADER_SIZE + key.size() + value.size()){
+            slotSize *= 2;
+        }
+        keys.push_back(key);
+    }
+
+    RuntimeMinimalPerfectHash mph;
+    if(!buildMinimalPerfectHash(layout, std::move(keys), mph)){
+        return false;
+    }
+
+    StaticIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.numKeys = mph.numKeys;
+    header.numBuckets = mph.numBuckets;
+    header.slotSize = slotSize;
+    header.pilotsOffset = sizeof(StaticIndexHeader);
+    header.slotsOffset = roundUp(header.pilotsOffset + mph.numBuckets * sizeof(uint32_t), INDEX_CACHE_LINE);
+    header.fileSize = header.slotsOffset + mph.numKeys * slotSize;
+    header.keySize = layout.keySize;
+    header.numLoads = layout.loads.size();
+    for(std::size_t i = 0; i < layout.loads.size(); i++){
+        header.loads[i][0] = layout.loads[i].offset;
+        header.loads[i][1] = layout.loads[i].mask;
+        header.loads[i][2] = layout.loads[i].shift;
+    }
+
+    // Fill the file through a shared mapping, so the slots are never held twice in memory
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+        return false;
+    }
+    if(ftruncate(fd, header.fileSize) != 0){
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, header.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED){
+        return false;
+    }
+    char* file = (char*)mapped;
+
+    memcpy(file, &header, sizeof(header));
+    memcpy(file + header.pilotsOffset, mph.pilots, mph.numBuckets * sizeof(uint32_t));
+
+    std::vector<bool> filled(mph.numKeys, false);
+    for(const auto& [key, value] : entries){
+        const std::size_t position = mph(key);
+        // Distinct keys have distinct positions, so a filled slot holds an earlier copy of this key
+        if(filled[position]){
+            continue;
+        }
+        filled[position] = true;
+        char* slot = file + header.slotsOffset + position * slotSize;
+        const uint16_t sizes[2] = {(uint16_t)key.size(), (uint16_t)value.size()};
+        memcpy(slot, sizes, sizeof(sizes));
+        memcpy(slot + SLOT_HEADER_SIZE, key.data(), key.size());
+        memcpy(slot + SLOT_HEADER_SIZE + key.size(), value.data(), value.size());
+    }
+
+    return munmap(mapped, header.fileSize) == 0;
+}
+
+StaticIndex::~StaticIndex(){
+    if(data){
+        munmap((void*)data, dataSize);
+    }
+}
+
+bool StaticIndex::open(const std::string& path){
+    if(data){
+        munmap((void*)data, dataSize);
+        data = nullptr;
+        header = nullptr;
+    }
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        return false;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || (std::size_t)fileStat.st_size < sizeof(StaticIndexHeader)){
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED){
+        return false;
+    }
+    // Lookups touch one pilot and one slot, read ahead would only pollute the page cache
+    madvise(mapped, fileStat.st_size, MADV_RANDOM);
+    data = (const char*)mapped;
+    dataSize = fileStat.st_size;
+
+    const StaticIndexHeader* candidate = (const StaticIndexHeader*)data;
+    if(memcmp(candidate->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+       candidate->fileSize != dataSize ||
+       candidate->numLoads > MAX_RUNTIME_LOADS ||
+       candidate->slotSize < SLOT_HEADER_SIZE ||
+       candidate->pilotsOffset + candidate->numBuckets * sizeof(uint32_t) > candidate->slotsOffset ||
+       candidate->slotsOffset + candidate->numKeys * candidate->slotSize != dataSize)
+    {
+        return false;
+    }
+    header = candidate;
+
+    PextLayout layout;
+    layout.keySize = header->keySize;
+    for(std::size_t i = 0; i < header->numLoads; i++){
+        PextLoad load;
+        load.offset = header->loads[i][0];
+        load.mask = header->loads[i][1];
+        load.shift = header->loads[i][2];
+        layout.loads.push_back(load);
+    }
+    hash.firstLevel = AdaptivePextHash(layout);
+    hash.pilots = (const uint32_t*)(data + header->pilotsOffset);
+    hash.numKeys = header->numKeys;
+    hash.numBuckets = header->numBuckets;
+    return true;
+}
+
+bool StaticIndex::find(const std::string& key, std::string_view& value) const {
+    if(size() == 0){
+        return false;
+    }
+    const char* slot = data + header->slotsOffset + hash(key) * header->slotSize;
+    uint16_t sizes[2];
+    memcpy(sizes, slot, sizeof(sizes));
+    if(sizes[0] != key.size() || memcmp(slot + SLOT_HEADER_SIZE, key.data(), key.size()) != 0){
+        return false;
+    }
+    value = std::string_view(slot + SLOT_HEADER_SIZE + sizes[0], sizes[1]);
+    return true;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file staticIndex.hpp
+ * @brief This file contains an immutable, memory mapped hash index built with the synthesized hash functions.
+ *
+ * The index is a single file holding a header, the pilots of a minimal perfect hash function, and a slot for every key.
+ * Opening it only maps the file, so lookups run straight on the page cache without rebuilding any container.
+ */
+
+#ifndef STATIC_INDEX_HPP
+#define STATIC_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "runtimeHashes.hpp"
+
+/**
+ * @brief Size of a cache line. The pilots and the slots of the index start at cache line boundaries.
+ */
+constexpr std::size_t INDEX_CACHE_LINE = 64;
+
+/**
+ * @brief Header of an index file. Every field is stored in the machine's byte order.
+ */
+struct alignas(INDEX_CACHE_LINE) StaticIndexHeader{
+    char magic[8]; ///< Always "sepeidx1".
+    uint64_t numKeys; ///< Number of keys, and of slots.
+    uint64_t numBuckets; ///< Number of pilots of the minimal perfect hash function.
+    uint64_t slotSize; ///< Size of a slot, a power of two, so slots up to a cache line never cross one.
+    uint64_t pilotsOffset; ///< Offset of the pilots in the file.
+    uint64_t slotsOffset; ///< Offset of the slots in the file.
+    uint64_t fileSize; ///< Size of the file.
+    uint64_t keySize; ///< Size of the keys of the layout.
+    uint64_t numLoads; ///< Number of loads of the layout.
+    uint64_t loads[MAX_RUNTIME_LOADS][3]; ///< Offset, mask, and shift of every load of the layout.
+};
+
+/**
+ * @brief Builds an index file from key/value pairs.
+ *
+ * Every slot holds the 16 bits key size, the 16 bits value size, the key, and the value. The slot of a key is its
+ * position in the minimal perfect hash function of the keys, so a lookup reads one pilot and one slot.
+ *
+ * @param layout The layout of the first-level Pext hash function. Must have at most MAX_RUNTIME_LOADS loads.
+ * @param entries The key/value pairs. For duplicated keys, the first value is kept.
+ * @param path The path of the index file to write.
+ * @return true If the index was written.
+ * @return false If the minimal perfect hash function can not be built, a key or value has more than 65535 bytes, or
+ * the file can not be written.
+ */
+bool buildStaticIndex(const PextLayout& layout,
+                      const std::vector<std::pair<std::string, std::string>>& entries,
+                      const std::string& path);
+
+/**
+ * @brief A read-only view of an index file mapped into memory.
+ */
+class StaticIndex{
+    const char* data = nullptr; ///< The mapped file.
+    std::size_t dataSize = 0; ///< Size of the mapped file.
+    const StaticIndexHeader* header = nullptr; ///< The header, at the beginning of the mapped file.
+    RuntimeMinimalPerfectHash hash; ///< The hash function, whose pilots point into the mapped file.
+
+    public:
+        StaticIndex() = default;
+        StaticIndex(const StaticIndex&) = delete;
+        StaticIndex& operator=(const StaticIndex&) = delete;
+
+        /**
+         * @brief Destroy the Static Index object, unmapping its file.
+         */
+        ~StaticIndex();
+
+        /**
+         * @brief Maps an index file built by buildStaticIndex.
+         *
+         * @param path The path of the index file.
+         * @return true If the file was mapped and its header is valid.
+         * @return false Otherwise.
+         */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Search for a key in the index.
+         *
+         * @param key The key to search for.
+         * @param value The value of the key, pointing into the mapped file. Only set if the key is found.
+         * @return true If the key is in the index.
+         * @return false Otherwise.
+         */
+        bool find(const std::string& key, std::string_view& value) const;
+
+        /**
+         * @brief Get the number of keys in the index.
+         */
+        std::size_t size() const { return header ? header->numKeys : 0; }
+};
+
+#endif